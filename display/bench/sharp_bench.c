@@ -0,0 +1,337 @@
+// Userspace bench for the Sharp memory LCD update engine (sharp_core.h).
+//
+// Replays framebuffer sequences through the same scan/pack/diff code the
+// driver runs, records every SPI transfer in a fake sink, and reports scan
+// time, lines and bytes sent per frame. The recorded stream is checked
+// byte for byte against a copy of the driver's original update loop.
+//
+// Build with "make bench" in the display directory.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#include "../sharp_core.h"
+
+#define DEFAULT_FRAMES 300
+
+//-------------------------------------------------------------------------
+
+// Fake SPI controller: appends every transfer to a growing buffer
+struct fakeSpi {
+  unsigned char *data;
+  size_t len;
+  size_t cap;
+  unsigned long transfers;
+};
+
+static void fakeSpiSend(void *priv, const unsigned char *buf, int len) {
+  struct fakeSpi *spi = priv;
+  
+  if(spi->len + len > spi->cap) {
+    spi->cap = (spi->cap + len) * 2;
+    spi->data = realloc(spi->data, spi->cap);
+    if(!spi->data) {
+      perror("realloc");
+      exit(EXIT_FAILURE);
+    }
+  }
+  memcpy(spi->data + spi->len, buf, len);
+  spi->len += len;
+  spi->transfers++;
+}
+
+//-------------------------------------------------------------------------
+
+// The driver's update loop before the core was factored out, kept as the
+// reference for byte-exact output (1-bit panels). char is unsigned on ARM,
+// hence the cast in the comparison.
+static void legacyUpdate(unsigned char *screenBufferCompressed, const u8 *fb, struct fakeSpi *spi) {
+  int x, y, i;
+  char pixel;
+  char hasChanged = 0;
+  char bufferByte = 0;
+  
+  for(y=0 ; y < 240 ; y++) {
+    
+    hasChanged = 0;
+    
+    for(x=0 ; x<50 ; x++) {
+      for(i=0 ; i<8 ; i++ ) {
+        
+        pixel = fb[x*8 + y*400 + i];
+        
+        if(pixel) {
+          bufferByte |=  (1 << (7 - i)); 
+        }
+        else {
+          bufferByte &=  ~(1 << (7 - i)); 
+        }
+      }
+      
+      if(screenBufferCompressed[x + 2 + y*(50+4)] != (unsigned char)bufferByte) {
+        hasChanged = 1;
+        screenBufferCompressed[x+2 + y*(50+4)] = bufferByte;
+      }
+    }
+    
+    if(hasChanged) {
+      fakeSpiSend(spi, screenBufferCompressed+(y*(50+4)), 54);
+    }
+  }
+}
+
+static void legacyInit(unsigned char *screenBufferCompressed, struct fakeSpi *spi) {
+  int y;
+  
+  for(y=0 ; y < 240 ; y++) {
+    screenBufferCompressed[y*(50+4)] = SHARP_CMD_UPDATE;
+    screenBufferCompressed[y*(50+4) + 1] = sharpReverseByte(y+1);
+    screenBufferCompressed[y*(50+4) + 52] = SHARP_PADDING;
+    screenBufferCompressed[y*(50+4) + 53] = SHARP_PADDING;
+    fakeSpiSend(spi, screenBufferCompressed+(y*(50+4)), 54);
+  }
+}
+
+// Straightforward pixel-at-a-time 3-bit packer, the reference for color mode
+static void referenceColorUpdate(unsigned char *shadow, const u16 *fb, struct fakeSpi *spi) {
+  unsigned char line[150];
+  int x, y, bit;
+  u16 p;
+  
+  for(y=0 ; y < 240 ; y++) {
+    memset(line, 0, sizeof(line));
+    for(x=0 ; x < 400 ; x++) {
+      p = fb[y*400 + x];
+      bit = x*3;
+      if(p & 0x8000) line[bit/8] |= 0x80 >> (bit%8);
+      bit++;
+      if(p & 0x0400) line[bit/8] |= 0x80 >> (bit%8);
+      bit++;
+      if(p & 0x0010) line[bit/8] |= 0x80 >> (bit%8);
+    }
+    if(memcmp(shadow + y*154 + 2, line, 150)) {
+      memcpy(shadow + y*154 + 2, line, 150);
+      fakeSpiSend(spi, shadow + y*154, 154);
+    }
+  }
+}
+
+static void referenceColorInit(unsigned char *shadow, struct fakeSpi *spi) {
+  int y;
+  
+  for(y=0 ; y < 240 ; y++) {
+    shadow[y*154] = SHARP_CMD_UPDATE;
+    shadow[y*154 + 1] = y+1;
+    shadow[y*154 + 152] = SHARP_PADDING;
+    shadow[y*154 + 153] = SHARP_PADDING;
+    fakeSpiSend(spi, shadow + y*154, 154);
+  }
+}
+
+//-------------------------------------------------------------------------
+
+// Synthetic recordings. Pixels are written as 8bpp values; color mode
+// expands them to RGB565 afterwards.
+
+static uint32_t randomState = 12345;
+
+static uint32_t nextRandom(void) {
+  randomState = randomState * 1103515245 + 12345;
+  return randomState >> 8;
+}
+
+// An 8x8 pseudo glyph cell, blank for spaces
+static void drawCell(u8 *fb, int col, int row, uint32_t glyph) {
+  int x, y;
+  
+  for(y=0 ; y<8 ; y++) {
+    for(x=0 ; x<8 ; x++) {
+      fb[(row*8 + y)*400 + col*8 + x] = (glyph && x < 6 && y < 7 && ((glyph >> ((x*7 + y) % 31)) & 1)) ? 15 : 0;
+    }
+  }
+}
+
+// Full screen of text scrolling up one text row per frame
+static void scenarioScroll(u8 *fb, int frame) {
+  int col;
+  
+  memmove(fb, fb + 8*400, (240-8)*400);
+  for(col=0 ; col<50 ; col++) drawCell(fb, col, 29, (col + frame) % 7 ? nextRandom() : 0);
+}
+
+// One character typed per frame, with a cursor blinking every 15 frames
+static void scenarioTyping(u8 *fb, int frame) {
+  int pos = frame % (50*30);
+  
+  if(frame == 0) memset(fb, 0, 400*240);
+  drawCell(fb, pos % 50, pos / 50, nextRandom() | 1);
+  drawCell(fb, (pos+1) % 50, ((pos+1) / 50) % 30, (frame / 15) & 1 ? 0xffffffff : 0);
+}
+
+// Moving full-frame content, where nearly every line changes
+static void scenarioVideo(u8 *fb, int frame) {
+  int x, y;
+  
+  for(y=0 ; y<240 ; y++) {
+    for(x=0 ; x<400 ; x++) {
+      fb[y*400 + x] = ((x + frame*3) ^ (y + frame)) & 0x10 ? 0xff : 0;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------
+
+static uint64_t nanoseconds(void) {
+  struct timespec ts;
+  
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void toRgb565(u16 *dst, const u8 *src) {
+  int i;
+  
+  int color;
+  
+  // Cycle lit pixels through the 7 non-black panel colors, one per line
+  for(i=0 ; i < 400*240 ; i++) {
+    color = src[i] ? (src[i] + i/400) % 7 + 1 : 0;
+    dst[i] = (color & 4 ? 0xf800 : 0) | (color & 2 ? 0x07e0 : 0) | (color & 1 ? 0x001f : 0);
+  }
+}
+
+struct replay {
+  const char *name;
+  void (*next)(u8 *fb, int frame);
+  FILE *file;
+};
+
+// Runs one sequence through the core and the reference, returns 0 if they match
+static int runSequence(struct replay *r, int frames, int colorMode) {
+  int lineBytes = colorMode ? 150 : 50;
+  int frameBytes = 400*240*(colorMode ? 2 : 1);
+  u8 *grey = calloc(400*240, 1);
+  void *fb = calloc(frameBytes, 1);
+  unsigned char *referenceShadow = calloc(sharpShadowSize(lineBytes), 1);
+  struct fakeSpi coreSpi = { 0 }, referenceSpi = { 0 };
+  struct sharpCore core = { 0 };
+  uint64_t scanNs = 0, start;
+  unsigned long lines = 0;
+  int frame, y, ok;
+  
+  core.shadow = calloc(sharpShadowSize(lineBytes), 1);
+  core.lineBytes = lineBytes;
+  core.colorMode = colorMode;
+  core.send = fakeSpiSend;
+  core.priv = &coreSpi;
+  
+  if(!grey || !fb || !referenceShadow || !core.shadow) {
+    perror("calloc");
+    exit(EXIT_FAILURE);
+  }
+  
+  sharpInitShadow(&core);
+  for(y=0 ; y<240 ; y++) sharpSendLine(&core, y);
+  if(colorMode) referenceColorInit(referenceShadow, &referenceSpi);
+  else legacyInit(referenceShadow, &referenceSpi);
+  
+  size_t initBytes = coreSpi.len;
+  
+  for(frame=0 ; frame<frames ; frame++) {
+    if(r->file) {
+      if(fread(fb, frameBytes, 1, r->file) != 1) break;
+    }
+    else {
+      r->next(grey, frame);
+      if(colorMode) toRgb565(fb, grey);
+      else memcpy(fb, grey, frameBytes);
+    }
+    
+    start = nanoseconds();
+    lines += sharpUpdateFb(&core, fb);
+    scanNs += nanoseconds() - start;
+    
+    if(colorMode) referenceColorUpdate(referenceShadow, fb, &referenceSpi);
+    else legacyUpdate(referenceShadow, fb, &referenceSpi);
+  }
+  
+  ok = coreSpi.len == referenceSpi.len && !memcmp(coreSpi.data, referenceSpi.data, coreSpi.len);
+  
+  printf("%-10s %6d %12.0f %10.1f %12.0f   %s\n",
+         r->name,
+         frame,
+         frame ? (double)scanNs / frame : 0.0,
+         frame ? (double)lines / frame : 0.0,
+         frame ? (double)(coreSpi.len - initBytes) / frame : 0.0,
+         ok ? "identical" : "MISMATCH");
+  
+  free(coreSpi.data);
+  free(referenceSpi.data);
+  free(core.shadow);
+  free(referenceShadow);
+  free(fb);
+  free(grey);
+  return ok ? 0 : 1;
+}
+
+static void printUsage(FILE *fp, const char *name) {
+  fprintf(fp, "\n");
+  fprintf(fp, "Usage: %s <options>\n", name);
+  fprintf(fp, "\n");
+  fprintf(fp, "Options:\n");
+  fprintf(fp, "  --color               Drive an 8-color panel (RGB565 frames)\n");
+  fprintf(fp, "  --frames <n>          Frames per sequence (default %d)\n", DEFAULT_FRAMES);
+  fprintf(fp, "  --replay <file>       Replay raw 400x240 frames (8bpp, or RGB565 with --color)\n");
+  fprintf(fp, "  --help                Print usage and exit\n");
+}
+
+int main(int argc, char *argv[]) {
+  struct replay scenarios[] = {
+    { "scroll", scenarioScroll, NULL },
+    { "typing", scenarioTyping, NULL },
+    { "video", scenarioVideo, NULL },
+  };
+  struct replay recording = { "replay", NULL, NULL };
+  int frames = DEFAULT_FRAMES;
+  int colorMode = 0;
+  int failures = 0;
+  int i;
+  
+  for(i=1 ; i<argc ; i++) {
+    if(!strcmp(argv[i], "--color")) colorMode = 1;
+    else if(!strcmp(argv[i], "--frames") && i+1 < argc) frames = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--replay") && i+1 < argc) {
+      recording.file = fopen(argv[++i], "rb");
+      if(!recording.file) {
+        perror(argv[i]);
+        return EXIT_FAILURE;
+      }
+    }
+    else {
+      printUsage(strcmp(argv[i], "--help") ? stderr : stdout, argv[0]);
+      return strcmp(argv[i], "--help") ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+  }
+  
+  printf("%s panel, SPI output checked against the reference update loop\n\n", colorMode ? "8-color" : "1-bit");
+  printf("%-10s %6s %12s %10s %12s   %s\n", "sequence", "frames", "scan ns/fr", "lines/fr", "bytes/fr", "SPI stream");
+  
+  if(recording.file) {
+    failures += runSequence(&recording, frames, colorMode);
+    fclose(recording.file);
+  }
+  else {
+    for(i=0 ; i < (int)(sizeof(scenarios)/sizeof(scenarios[0])) ; i++) {
+      failures += runSequence(&scenarios[i], frames, colorMode);
+    }
+  }
+  
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -18,8 +18,18 @@
 
 #include <linux/gpio.h>
 #include <linux/uaccess.h>
+#include <linux/list.h>
+#include <linux/wait.h>
+
+#include <media/v4l2-device.h>
+#include <media/v4l2-ioctl.h>
+#include <media/videobuf2-v4l2.h>
+#include <media/videobuf2-vmalloc.h>
+
+#include "sharp_core.h"
 
 #define LCDWIDTH 400
+#define LCDHEIGHT 240
 #define VIDEOMEMSIZE    (1*1024*1024)   /* 1 MB */
 
 char commandByte = 0b10000000;
@@ -38,6 +48,30 @@ int fpsCounter;
 static int seuil = 4; // Indispensable pour fbcon
 module_param(seuil, int, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP );
 
+// 0: 1-bit Sharp panel fed from an 8bpp fb
+// 1: 8-color memory LCD (3-bit data update mode) fed from an RGB565 fb
+static int colorMode = 0;
+module_param(colorMode, int, S_IRUSR | S_IRGRP );
+MODULE_PARM_DESC(colorMode, "Drive an 8-color memory LCD in 3-bit data update mode (RGB565 framebuffer)");
+
+// Temporal pseudo-grayscale (FRC) on the 8bpp fb: number of bitplanes cycled
+// while the screen is static, 0 to disable
+static int frc = 0;
+module_param(frc, int, S_IRUSR | S_IRGRP );
+MODULE_PARM_DESC(frc, "Cycle 2 or 3 gray bitplanes over idle refreshes (0 = off)");
+
+// Scans without damage needed before FRC takes the bus again
+#define FRC_IDLE_SCANS 5
+
+// Smaller values are what snag (1) and fbcon (palette indices) write, not grays
+#define FRC_MIN_GREY 16
+
+// Data bytes per panel line, the shadow buffer adds command, address and 2 padding bytes
+int lineBytes = LCDWIDTH/8;
+
+// Packed shadow of what is on the glass, see sharp_core.h
+static struct sharpCore core;
+
 char vcomState;
 
 unsigned char lineBuffer[LCDWIDTH/8];
@@ -50,6 +84,22 @@ struct sharp {
   struct mutex		mutex;
   struct work_struct	work;
   spinlock_t		lock;
+
+  // V4L2 output node, fed to the panel by the update thread
+  struct v4l2_device	v4l2Dev;
+  struct video_device	vdev;
+  struct vb2_queue	queue;
+  struct mutex		queueLock;
+  struct list_head	bufList;
+  wait_queue_head_t	bufWait;
+  u32			pixelformat;
+  u32			sequence;
+  bool			streaming;
+};
+
+struct sharpBuffer {
+  struct vb2_v4l2_buffer vb;
+  struct list_head	list;
 };
 
 struct sharp   *screen;
@@ -60,7 +110,8 @@ static u_long videomemorysize = VIDEOMEMSIZE;
 
 void vfb_fillrect(struct fb_info *p, const struct fb_fillrect *region);
 static int vfb_mmap(struct fb_info *info, struct vm_area_struct *vma);
-void sendLine(char *buffer, char lineNumber);
+static int vfb_setcolreg(u_int regno, u_int red, u_int green, u_int blue, u_int transp, struct fb_info *info);
+static void sendSpiLine(void *priv, const unsigned char *buf, int len);
 
 static struct fb_var_screeninfo vfb_default = {
   .xres           = 400,
@@ -103,8 +154,11 @@ static struct fb_ops vfb_ops = {
   .fb_copyarea  = sys_copyarea,
   .fb_imageblit = sys_imageblit,
   .fb_mmap      = vfb_mmap,
+  .fb_setcolreg = vfb_setcolreg,
 };
 
+static u32 pseudoPalette[16];
+
 static struct task_struct *thread1;
 static struct task_struct *fpsThread;
 static struct task_struct *vcomToggleThread;
@@ -138,6 +192,14 @@ static int vfb_mmap(struct fb_info *info, struct vm_area_struct *vma) {
   return 0;
 }
 
+// Only used in color mode, where fbcon draws through the RGB565 pseudo palette
+static int vfb_setcolreg(u_int regno, u_int red, u_int green, u_int blue, u_int transp, struct fb_info *info) {
+  if (info->fix.visual != FB_VISUAL_TRUECOLOR || regno >= 16) return 1;
+  
+  pseudoPalette[regno] = ((red & 0xf800) | ((green & 0xfc00) >> 5) | ((blue & 0xf800) >> 11));
+  return 0;
+}
+
 void vfb_fillrect(struct fb_info *p, const struct fb_fillrect *region) {
     printk(KERN_CRIT "from fillrect");
 }
@@ -182,13 +244,6 @@ void clearDisplay(void) {
   gpio_set_value(SCS, 0);
 }
 
-char reverseByte(char b) {
-  b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
-  b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
-  b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
-  return b;
-}
-
 int vcomToggleFunction(void* v) {
   while (!kthread_should_stop()) {
     msleep(50);
@@ -207,76 +262,471 @@ int fpsThreadFunction(void* v) {
   return 0;
 }
 
-int thread_fn(void* v) {
-  int x, y, i;
-  char pixel;
-  char hasChanged = 0;
+// V4L2 output node
+//
+// Frames queued on the video device (GREY or Y10, 400x240) are dithered,
+// packed and line-diffed by the update thread in place of the framebuffer
+// scan. While the queue is streaming the framebuffer is ignored; once it
+// stops, the next scan restores whatever the framebuffer holds.
+
+static const u32 sharpFormats[] = { V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_Y10 };
+
+static u32 sharpBytesPerLine(u32 pixelformat) {
+  return pixelformat == V4L2_PIX_FMT_Y10 ? LCDWIDTH * 2 : LCDWIDTH;
+}
+
+static void sharpFillFormat(struct v4l2_pix_format *pix, u32 pixelformat) {
+  pix->width        = LCDWIDTH;
+  pix->height       = LCDHEIGHT;
+  pix->field        = V4L2_FIELD_NONE;
+  pix->pixelformat  = pixelformat;
+  pix->bytesperline = sharpBytesPerLine(pixelformat);
+  pix->sizeimage    = pix->bytesperline * LCDHEIGHT;
+  pix->colorspace   = V4L2_COLORSPACE_RAW;
+}
+
+static int sharpQueueSetup(struct vb2_queue *vq, unsigned int *nbuffers,
+                           unsigned int *nplanes, unsigned int sizes[],
+                           struct device *allocDevs[]) {
+  struct sharp *s = vb2_get_drv_priv(vq);
+  unsigned int size = sharpBytesPerLine(s->pixelformat) * LCDHEIGHT;
   
-  unsigned char *screenBufferCompressed;
-  char bufferByte = 0;
-  char sendBuffer[1 + (1+50+1)*1 + 1];
+  if (*nplanes) return sizes[0] < size ? -EINVAL : 0;
   
-  clearDisplay();
+  *nplanes = 1;
+  sizes[0] = size;
+  return 0;
+}
+
+static int sharpBufPrepare(struct vb2_buffer *vb) {
+  struct sharp *s = vb2_get_drv_priv(vb->vb2_queue);
+  unsigned long size = sharpBytesPerLine(s->pixelformat) * LCDHEIGHT;
   
-  //unsigned char *screenBufferCompressed;
-  screenBufferCompressed = vzalloc((50+4)*240*sizeof(unsigned char)); 	//plante si on met moins
+  if (vb2_get_plane_payload(vb, 0) < size) return -EINVAL;
+  return 0;
+}
+
+static void sharpBufQueue(struct vb2_buffer *vb) {
+  struct vb2_v4l2_buffer *vbuf = to_vb2_v4l2_buffer(vb);
+  struct sharpBuffer *buf = container_of(vbuf, struct sharpBuffer, vb);
+  struct sharp *s = vb2_get_drv_priv(vb->vb2_queue);
+  unsigned long flags;
   
-  sendBuffer[0] = commandByte;
-  sendBuffer[52] = paddingByte;
-  sendBuffer[1 + 52] = paddingByte;
+  spin_lock_irqsave(&s->lock, flags);
+  list_add_tail(&buf->list, &s->bufList);
+  spin_unlock_irqrestore(&s->lock, flags);
   
-  // Init screen to black
-  for(y=0 ; y < 240 ; y++) {
-    gpio_set_value(SCS, 1);
-    screenBufferCompressed[y*(50+4)] = commandByte;
-    screenBufferCompressed[y*(50+4) + 1] = reverseByte(y+1); //sharp display lines are indexed from 1
-    screenBufferCompressed[y*(50+4) + 52] = paddingByte;
-    screenBufferCompressed[y*(50+4) + 53] = paddingByte;
+  wake_up(&s->bufWait);
+}
+
+static void sharpReturnBuffers(struct sharp *s, enum vb2_buffer_state state) {
+  struct sharpBuffer *buf, *tmp;
+  unsigned long flags;
+  
+  spin_lock_irqsave(&s->lock, flags);
+  list_for_each_entry_safe(buf, tmp, &s->bufList, list) {
+    list_del(&buf->list);
+    vb2_buffer_done(&buf->vb.vb2_buf, state);
+  }
+  spin_unlock_irqrestore(&s->lock, flags);
+}
+
+static int sharpStartStreaming(struct vb2_queue *vq, unsigned int count) {
+  struct sharp *s = vb2_get_drv_priv(vq);
+  
+  s->sequence = 0;
+  WRITE_ONCE(s->streaming, true);
+  wake_up(&s->bufWait);
+  return 0;
+}
+
+static void sharpStopStreaming(struct vb2_queue *vq) {
+  struct sharp *s = vb2_get_drv_priv(vq);
+  
+  WRITE_ONCE(s->streaming, false);
+  
+  // Wait for the update thread to finish the frame it may be sending
+  mutex_lock(&s->mutex);
+  sharpReturnBuffers(s, VB2_BUF_STATE_ERROR);
+  mutex_unlock(&s->mutex);
+}
+
+static const struct vb2_ops sharpQueueOps = {
+  .queue_setup     = sharpQueueSetup,
+  .buf_prepare     = sharpBufPrepare,
+  .buf_queue       = sharpBufQueue,
+  .start_streaming = sharpStartStreaming,
+  .stop_streaming  = sharpStopStreaming,
+  .wait_prepare    = vb2_ops_wait_prepare,
+  .wait_finish     = vb2_ops_wait_finish,
+};
+
+static int sharpQuerycap(struct file *file, void *priv, struct v4l2_capability *cap) {
+  struct sharp *s = video_drvdata(file);
+  
+  strscpy(cap->driver, "sharp", sizeof(cap->driver));
+  strscpy(cap->card, "Sharp memory LCD", sizeof(cap->card));
+  snprintf(cap->bus_info, sizeof(cap->bus_info), "spi:%s", dev_name(&s->spi->dev));
+  return 0;
+}
+
+static int sharpEnumFmt(struct file *file, void *priv, struct v4l2_fmtdesc *f) {
+  if (f->index >= ARRAY_SIZE(sharpFormats)) return -EINVAL;
+  
+  f->pixelformat = sharpFormats[f->index];
+  return 0;
+}
+
+static int sharpGetFmt(struct file *file, void *priv, struct v4l2_format *f) {
+  struct sharp *s = video_drvdata(file);
+  
+  sharpFillFormat(&f->fmt.pix, s->pixelformat);
+  return 0;
+}
+
+static int sharpTryFmt(struct file *file, void *priv, struct v4l2_format *f) {
+  u32 pixelformat = f->fmt.pix.pixelformat == V4L2_PIX_FMT_Y10 ? V4L2_PIX_FMT_Y10 : V4L2_PIX_FMT_GREY;
+  
+  sharpFillFormat(&f->fmt.pix, pixelformat);
+  return 0;
+}
+
+static int sharpSetFmt(struct file *file, void *priv, struct v4l2_format *f) {
+  struct sharp *s = video_drvdata(file);
+  
+  if (vb2_is_busy(&s->queue)) return -EBUSY;
+  
+  sharpTryFmt(file, priv, f);
+  s->pixelformat = f->fmt.pix.pixelformat;
+  return 0;
+}
+
+static int sharpEnumOutput(struct file *file, void *priv, struct v4l2_output *out) {
+  if (out->index) return -EINVAL;
+  
+  out->type = V4L2_OUTPUT_TYPE_ANALOG;
+  strscpy(out->name, "Sharp memory LCD", sizeof(out->name));
+  return 0;
+}
+
+static int sharpGetOutput(struct file *file, void *priv, unsigned int *i) {
+  *i = 0;
+  return 0;
+}
+
+static int sharpSetOutput(struct file *file, void *priv, unsigned int i) {
+  return i ? -EINVAL : 0;
+}
+
+static const struct v4l2_ioctl_ops sharpIoctlOps = {
+  .vidioc_querycap         = sharpQuerycap,
+  .vidioc_enum_fmt_vid_out = sharpEnumFmt,
+  .vidioc_g_fmt_vid_out    = sharpGetFmt,
+  .vidioc_try_fmt_vid_out  = sharpTryFmt,
+  .vidioc_s_fmt_vid_out    = sharpSetFmt,
+  .vidioc_enum_output      = sharpEnumOutput,
+  .vidioc_g_output         = sharpGetOutput,
+  .vidioc_s_output         = sharpSetOutput,
+  .vidioc_reqbufs          = vb2_ioctl_reqbufs,
+  .vidioc_create_bufs      = vb2_ioctl_create_bufs,
+  .vidioc_prepare_buf      = vb2_ioctl_prepare_buf,
+  .vidioc_querybuf         = vb2_ioctl_querybuf,
+  .vidioc_qbuf             = vb2_ioctl_qbuf,
+  .vidioc_dqbuf            = vb2_ioctl_dqbuf,
+  .vidioc_expbuf           = vb2_ioctl_expbuf,
+  .vidioc_streamon         = vb2_ioctl_streamon,
+  .vidioc_streamoff        = vb2_ioctl_streamoff,
+};
+
+static const struct v4l2_file_operations sharpFileOps = {
+  .owner          = THIS_MODULE,
+  .open           = v4l2_fh_open,
+  .release        = vb2_fop_release,
+  .write          = vb2_fop_write,
+  .poll           = vb2_fop_poll,
+  .mmap           = vb2_fop_mmap,
+  .unlocked_ioctl = video_ioctl2,
+};
+
+static int sharpRegisterVideo(struct sharp *s) {
+  struct vb2_queue *q = &s->queue;
+  int retval;
+  
+  retval = v4l2_device_register(&s->spi->dev, &s->v4l2Dev);
+  if (retval) return retval;
+  
+  q->type            = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+  q->io_modes        = VB2_MMAP | VB2_DMABUF | VB2_WRITE;
+  q->drv_priv        = s;
+  q->buf_struct_size = sizeof(struct sharpBuffer);
+  q->ops             = &sharpQueueOps;
+  q->mem_ops         = &vb2_vmalloc_memops;
+  q->timestamp_flags = V4L2_BUF_FLAG_TIMESTAMP_COPY;
+  q->lock            = &s->queueLock;
+  q->dev             = &s->spi->dev;
+  
+  retval = vb2_queue_init(q);
+  if (retval) goto err;
+  
+  strscpy(s->vdev.name, "sharp-out", sizeof(s->vdev.name));
+  s->vdev.v4l2_dev    = &s->v4l2Dev;
+  s->vdev.fops        = &sharpFileOps;
+  s->vdev.ioctl_ops   = &sharpIoctlOps;
+  s->vdev.release     = video_device_release_empty;
+  s->vdev.lock        = &s->queueLock;
+  s->vdev.queue       = q;
+  s->vdev.vfl_dir     = VFL_DIR_TX;
+  s->vdev.device_caps = V4L2_CAP_VIDEO_OUTPUT | V4L2_CAP_STREAMING | V4L2_CAP_READWRITE;
+  video_set_drvdata(&s->vdev, s);
+  
+  retval = video_register_device(&s->vdev, VFL_TYPE_VIDEO, -1);
+  if (retval) goto err;
+  
+  return 0;
+  
+  err:
+    v4l2_device_unregister(&s->v4l2Dev);
+    return retval;
+}
+
+static void sendSpiLine(void *priv, const unsigned char *buf, int len) {
+  struct sharp *s = priv;
+  
+  gpio_set_value(SCS, 1);
+  spi_write(s->spi, (const u8 *)buf, len);
+  gpio_set_value(SCS, 0);
+}
+
+// Sends the oldest queued V4L2 frame, if any, and hands it back to userspace
+static void sendQueuedFrame(void) {
+  static u8 greyLine[LCDWIDTH];
+  struct sharpBuffer *buf;
+  unsigned long flags;
+  const u8 *frame;
+  const __le16 *y10;
+  u32 bytesPerLine;
+  int x, y;
+  
+  mutex_lock(&screen->mutex);
+  if (!READ_ONCE(screen->streaming)) goto out;
+  
+  spin_lock_irqsave(&screen->lock, flags);
+  buf = list_first_entry_or_null(&screen->bufList, struct sharpBuffer, list);
+  if (buf) list_del(&buf->list);
+  spin_unlock_irqrestore(&screen->lock, flags);
+  
+  if (!buf) goto out;
+  
+  frame = vb2_plane_vaddr(&buf->vb.vb2_buf, 0);
+  if (!frame) {
+    vb2_buffer_done(&buf->vb.vb2_buf, VB2_BUF_STATE_ERROR);
+    goto out;
+  }
+  
+  bytesPerLine = sharpBytesPerLine(screen->pixelformat);
+  
+  for(y=0 ; y < LCDHEIGHT ; y++) {
+    const u8 *grey = frame + y*bytesPerLine;
     
-    //screenBufferCompressed is all to 0 by default (vzalloc)
+    if (screen->pixelformat == V4L2_PIX_FMT_Y10) {
+      y10 = (const __le16 *)grey;
+      for(x=0 ; x < LCDWIDTH ; x++) greyLine[x] = le16_to_cpu(y10[x]) >> 2;
+      grey = greyLine;
+    }
     
-    spi_write(screen->spi, (const u8 *)(screenBufferCompressed+(y*(50+4))), 54);
-    gpio_set_value(SCS, 0);
+    if(sharpPackGreyLine(&core, y, grey)) {
+      sharpSendLine(&core, y);
+    }
   }
   
-  // Main loop
-  while (!kthread_should_stop()) {
-    msleep(10);
+  buf->vb.sequence = screen->sequence++;
+  buf->vb.field = V4L2_FIELD_NONE;
+  vb2_buffer_done(&buf->vb.vb2_buf, VB2_BUF_STATE_DONE);
+  
+  out:
+    mutex_unlock(&screen->mutex);
+}
+
+// Temporal pseudo-grayscale (FRC)
+//
+// Each gray pixel gets a level 0..frc and is lit in that many of the frc
+// bitplanes, with the phase offset by x+y so neighbouring pixels do not blink
+// together. Values below FRC_MIN_GREY are not grays: like in the mono path,
+// non-zero is white. Damage always wins: changed lines are sent as the mono
+// path would send them and the planes only start cycling again after
+// FRC_IDLE_SCANS quiet scans.
+
+static unsigned char *frcPrimary;  // non-zero is white, 50 bytes per line
+static unsigned char *frcPlanes;   // frc planes of 240 lines of 50 bytes
+static u8 frcLine[LCDHEIGHT];      // lines whose planes differ
+static int frcPlane;
+static int frcIdle;
+
+// Packs one gray fb line into the primary image and the bitplanes, returns 1 if it changed
+static int scanFrcLine(int y) {
+  const u8 *grey = (const u8 *)info->fix.smem_start + y*LCDWIDTH;
+  unsigned char *primary = frcPrimary + y*50;
+  unsigned char planeByte[3], primaryByte;
+  int x, i, k, level, phase, hasChanged = 0, isGray = 0;
+  
+  for(x=0 ; x<50 ; x++) {
+    primaryByte = 0;
+    planeByte[0] = planeByte[1] = planeByte[2] = 0;
+    phase = (x*8 + y) % frc;
     
-    for(y=0 ; y < 240 ; y++) {
+    for(i=0 ; i<8 ; i++) {
+      if(grey[x*8 + i] >= FRC_MIN_GREY) level = (grey[x*8 + i] * (frc + 1)) >> 8;
+      else level = grey[x*8 + i] ? frc : 0;
+      if(grey[x*8 + i]) primaryByte |= (1 << (7 - i));
       
-      hasChanged = 0;
-      
-      for(x=0 ; x<50 ; x++) {
-        for(i=0 ; i<8 ; i++ ) {
-          
-          pixel = ioread8((void*)((uintptr_t)info->fix.smem_start + (x*8 + y*400 + i)));
-          
-          if(pixel) {
-            // set bit 7 - i to 1
-            bufferByte |=  (1 << (7 - i)); 
-          }
-          else {
-            // set bit 7 - i to 0
-            bufferByte &=  ~(1 << (7 - i)); 
-          }
-        }
-        
-        if(screenBufferCompressed[x + 2 + y*(50+4)] != bufferByte) {
-          hasChanged = 1;
-          screenBufferCompressed[x+2 + y*(50+4)] = bufferByte;
-        }
+      for(k=0 ; k<frc ; k++) {
+        if(level > (phase + k) % frc) planeByte[k] |= (1 << (7 - i));
       }
-            
-      if(hasChanged) {
-          gpio_set_value(SCS, 1);
-          memcpy(sendBuffer, screenBufferCompressed+y*(50+4), 54);
-          spi_write(screen->spi, (const u8 *)(screenBufferCompressed+(y*(50+4))), 54);
-          gpio_set_value(SCS, 0);
+      if(++phase == frc) phase = 0;
+    }
+    
+    if(primary[x] != primaryByte) {
+      hasChanged = 1;
+      primary[x] = primaryByte;
+    }
+    for(k=0 ; k<frc ; k++) {
+      if(frcPlanes[(k*LCDHEIGHT + y)*50 + x] != planeByte[k]) {
+        hasChanged = 1;
+        frcPlanes[(k*LCDHEIGHT + y)*50 + x] = planeByte[k];
       }
+      if(planeByte[k] != planeByte[0]) isGray = 1;
     }
   }
   
+  frcLine[y] = isGray;
+  return hasChanged;
+}
+
+// Copies a packed line into the shadow buffer and sends it if it differs
+static void sendPackedLine(const unsigned char *packed, int y) {
+  if(sharpPackBitsLine(&core, y, packed)) sharpSendLine(&core, y);
+}
+
+// resendAll repaints every line, e.g. after streaming wrote the shadow behind our back
+static void updateFrc(int resendAll) {
+  int y, damage = 0;
+  
+  for(y=0 ; y < LCDHEIGHT ; y++) {
+    if(scanFrcLine(y) || resendAll) {
+      damage = 1;
+      sendPackedLine(frcPrimary + y*50, y);
+    }
+  }
+  
+  // Leave the bus to damage traffic until the screen settles
+  if(damage) {
+    frcIdle = 0;
+    return;
+  }
+  if(frcIdle < FRC_IDLE_SCANS) {
+    frcIdle++;
+    return;
+  }
+  
+  frcPlane = (frcPlane + 1) % frc;
+  for(y=0 ; y < LCDHEIGHT ; y++) {
+    if(frcLine[y]) sendPackedLine(frcPlanes + (frcPlane*LCDHEIGHT + y)*50, y);
+  }
+}
+
+// Screenshot: the packed shadow (what is on the glass) as a binary PBM,
+// /sys/class/graphics/fbN/screenshot. 1-bit panels only.
+
+static const char screenshotHeader[] = "P4\n400 240\n";
+
+static ssize_t screenshotRead(struct file *filp, struct kobject *kobj,
+                              struct bin_attribute *attr, char *buf,
+                              loff_t off, size_t count) {
+  size_t headerLen = sizeof(screenshotHeader) - 1;
+  size_t size = headerLen + LCDHEIGHT*50;
+  size_t i, pos;
+  
+  if (off >= size) return 0;
+  if (count > size - off) count = size - off;
+  if (!core.shadow) return -EAGAIN;
+  
+  mutex_lock(&screen->mutex);
+  for (i = 0; i < count; i++) {
+    pos = off + i;
+    if (pos < headerLen) {
+      buf[i] = screenshotHeader[pos];
+      continue;
+    }
+    pos -= headerLen;
+    // PBM uses 1 for black, the panel 1 for white
+    buf[i] = ~sharpShadowLine(&core, pos / 50)[2 + pos % 50];
+  }
+  mutex_unlock(&screen->mutex);
+  
+  return count;
+}
+
+static struct bin_attribute screenshotAttr = {
+  .attr = { .name = "screenshot", .mode = S_IRUSR | S_IRGRP },
+  .size = sizeof(screenshotHeader) - 1 + LCDHEIGHT*50,
+  .read = screenshotRead,
+};
+
+int thread_fn(void* v) {
+  int y, wasStreaming = 0;
+  
+  clearDisplay();
+  
+  if(frc) {
+    frcPrimary = vzalloc(LCDHEIGHT*50);
+    frcPlanes = vzalloc(frc*LCDHEIGHT*50);
+    if(!frcPrimary || !frcPlanes) {
+      vfree(frcPrimary);
+      vfree(frcPlanes);
+      frcPrimary = frcPlanes = NULL;
+      frc = 0;
+    }
+  }
+  
+  core.lineBytes = lineBytes;
+  core.colorMode = colorMode;
+  core.send = sendSpiLine;
+  core.priv = screen;
+  core.shadow = vzalloc(sharpShadowSize(lineBytes)); 	//plante si on met moins
+  
+  // Init screen to black
+  sharpInitShadow(&core);
+  for(y=0 ; y < 240 ; y++) {
+    sharpSendLine(&core, y);
+  }
+  
+  // Main loop
+  while (!kthread_should_stop()) {
+    if (READ_ONCE(screen->streaming)) {
+      wait_event_interruptible_timeout(screen->bufWait,
+                                       !list_empty_careful(&screen->bufList) ||
+                                       !READ_ONCE(screen->streaming) ||
+                                       kthread_should_stop(),
+                                       msecs_to_jiffies(10));
+      sendQueuedFrame();
+      wasStreaming = 1;
+      continue;
+    }
+    
+    msleep(10);
+    
+    // The mutex keeps screenshots from seeing a half-updated shadow
+    mutex_lock(&screen->mutex);
+    if(frc) updateFrc(wasStreaming);
+    else sharpUpdateFb(&core, (const void *)info->fix.smem_start);
+    mutex_unlock(&screen->mutex);
+    wasStreaming = 0;
+  }
+  
+  vfree(frcPrimary);
+  vfree(frcPlanes);
+  frcPrimary = frcPlanes = NULL;
+  
   return 0;
 }
 
@@ -289,10 +739,31 @@ static int sharp_probe(struct spi_device *spi) {
   screen = devm_kzalloc(&spi->dev, sizeof(*screen), GFP_KERNEL);
   if (!screen) return -ENOMEM;
   
+  if (colorMode || frc < 2) frc = 0;
+  if (frc > 3) frc = 3;
+  
+  if (colorMode) {
+    lineBytes = LCDWIDTH*3/8;
+    vfb_default.bits_per_pixel = 16;
+    vfb_default.grayscale      = 0;
+    vfb_default.red            = (struct fb_bitfield){ 11, 5, 0 };
+    vfb_default.green          = (struct fb_bitfield){ 5, 6, 0 };
+    vfb_default.blue           = (struct fb_bitfield){ 0, 5, 0 };
+    vfb_fix.line_length        = LCDWIDTH*2;
+    vfb_fix.visual             = FB_VISUAL_TRUECOLOR;
+  }
+  
   spi->bits_per_word  = 8;
   spi->max_speed_hz   = 8000000; // Testing higher speed
   
   screen->spi	= spi;
+  screen->pixelformat = V4L2_PIX_FMT_GREY;
+  
+  mutex_init(&screen->mutex);
+  mutex_init(&screen->queueLock);
+  spin_lock_init(&screen->lock);
+  INIT_LIST_HEAD(&screen->bufList);
+  init_waitqueue_head(&screen->bufWait);
   
   spi_set_drvdata(spi, screen);
   
@@ -338,6 +809,7 @@ static int sharp_probe(struct spi_device *spi) {
   vfb_fix.smem_len = videomemorysize;
   info->fix = vfb_fix;
   info->par = NULL;
+  info->pseudo_palette = pseudoPalette;
   info->flags = FBINFO_FLAG_DEFAULT;
   
   retval = fb_alloc_cmap(&info->cmap, 16, 0);
@@ -347,6 +819,15 @@ static int sharp_probe(struct spi_device *spi) {
   if (retval < 0) goto err2;
   
   fb_info(info, "Virtual frame buffer device, using %ldK of video memory\n", videomemorysize >> 10);
+  
+  if (!colorMode && device_create_bin_file(info->dev, &screenshotAttr)) {
+    dev_warn(&spi->dev, "cannot create screenshot attribute\n");
+  }
+  
+  if (sharpRegisterVideo(screen)) {
+    dev_warn(&spi->dev, "cannot register V4L2 output device\n");
+  }
+  
   return 0;
   
   err2:
@@ -359,7 +840,12 @@ static int sharp_probe(struct spi_device *spi) {
 }
 
 static int sharp_remove(struct spi_device *spi) {
+  if (video_is_registered(&screen->vdev)) {
+    vb2_video_unregister_device(&screen->vdev);
+    v4l2_device_unregister(&screen->v4l2Dev);
+  }
   if (info) {
+    if (!colorMode) device_remove_bin_file(info->dev, &screenshotAttr);
     unregister_framebuffer(info);
     fb_dealloc_cmap(&info->cmap);
     framebuffer_release(info);
@@ -0,0 +1,180 @@
+#ifndef SHARP_CORE_H
+#define SHARP_CORE_H
+
+// Scan/pack/diff/send engine of the Sharp memory LCD driver.
+//
+// Nothing in here touches the kernel: the same code is built into the module
+// and into the userspace bench (bench/sharp_bench.c). The includer provides
+// u8, u16, u32, memcmp() and memcpy(), and a send callback that puts one
+// shadow line on the bus.
+
+#define SHARP_WIDTH  400
+#define SHARP_HEIGHT 240
+
+#define SHARP_CMD_UPDATE 0x80   // also the 3-bit data update command of 8-color panels
+#define SHARP_PADDING    0x00
+
+struct sharpCore {
+  unsigned char *shadow;   // per line: command, address, lineBytes of data, 2 padding bytes
+  int lineBytes;           // 50 for 1-bit panels, 150 for 8-color panels
+  int colorMode;
+  void (*send)(void *priv, const unsigned char *buf, int len);
+  void *priv;
+};
+
+static const u8 sharpBayer4x4[4][4] = {
+  {   8, 136,  40, 168 },
+  { 200,  72, 232, 104 },
+  {  56, 184,  24, 152 },
+  { 248, 120, 216,  88 }
+};
+
+static inline int sharpShadowSize(int lineBytes) {
+  return (lineBytes+4)*SHARP_HEIGHT;
+}
+
+static inline unsigned char *sharpShadowLine(struct sharpCore *core, int y) {
+  return core->shadow + y*(core->lineBytes+4);
+}
+
+static inline char sharpReverseByte(char b) {
+  b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+  b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+  b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+  return b;
+}
+
+// Sharp panels take the line address LSB first, 8-color panels MSB first
+static inline char sharpLineAddress(struct sharpCore *core, int y) {
+  return core->colorMode ? (char)(y+1) : sharpReverseByte(y+1); //display lines are indexed from 1
+}
+
+// Writes the command, address and padding bytes around each (cleared) line
+static inline void sharpInitShadow(struct sharpCore *core) {
+  unsigned char *line;
+  int y;
+
+  for(y=0 ; y < SHARP_HEIGHT ; y++) {
+    line = sharpShadowLine(core, y);
+    memset(line + 2, 0, core->lineBytes);
+    line[0] = SHARP_CMD_UPDATE;
+    line[1] = sharpLineAddress(core, y);
+    line[core->lineBytes + 2] = SHARP_PADDING;
+    line[core->lineBytes + 3] = SHARP_PADDING;
+  }
+}
+
+static inline void sharpSendLine(struct sharpCore *core, int y) {
+  core->send(core->priv, sharpShadowLine(core, y), core->lineBytes+4);
+}
+
+// Packs one 8bpp fb line (any non-zero pixel is white), returns 1 if the line changed
+static inline int sharpPackMonoLine(struct sharpCore *core, int y, const u8 *pixels) {
+  unsigned char *data = sharpShadowLine(core, y) + 2;
+  unsigned char bufferByte;
+  int x, hasChanged = 0;
+
+  for(x=0 ; x<50 ; x++, pixels += 8) {
+    bufferByte = (pixels[0] ? 0x80 : 0) | (pixels[1] ? 0x40 : 0) |
+                 (pixels[2] ? 0x20 : 0) | (pixels[3] ? 0x10 : 0) |
+                 (pixels[4] ? 0x08 : 0) | (pixels[5] ? 0x04 : 0) |
+                 (pixels[6] ? 0x02 : 0) | (pixels[7] ? 0x01 : 0);
+
+    if(data[x] != bufferByte) {
+      hasChanged = 1;
+      data[x] = bufferByte;
+    }
+  }
+
+  return hasChanged;
+}
+
+// One pixel of RGB565 to the panel's R,G,B data bits (MSB of each channel)
+static inline u32 sharpRgb565To3bit(u16 p) {
+  return ((p >> 13) & 4) | ((p >> 9) & 2) | ((p >> 4) & 1);
+}
+
+// Stores 8 pixels of 3-bit data, returns 1 if they changed
+static inline int sharpStoreColorBits(unsigned char *data, u32 bits) {
+  if(data[0] == (u8)(bits >> 16) && data[1] == (u8)(bits >> 8) && data[2] == (u8)bits) return 0;
+
+  data[0] = bits >> 16;
+  data[1] = bits >> 8;
+  data[2] = bits;
+  return 1;
+}
+
+// Packs one RGB565 line into 3-bit data, 8 pixels (3 bytes) per step, returns 1 if the line changed
+static inline int sharpPackColorLine(struct sharpCore *core, int y, const u16 *rgb) {
+  unsigned char *data = sharpShadowLine(core, y) + 2;
+  int x, hasChanged = 0;
+  u32 bits;
+
+  for(x=0 ; x < SHARP_WIDTH ; x += 8, rgb += 8, data += 3) {
+    bits = (sharpRgb565To3bit(rgb[0]) << 21) | (sharpRgb565To3bit(rgb[1]) << 18) |
+           (sharpRgb565To3bit(rgb[2]) << 15) | (sharpRgb565To3bit(rgb[3]) << 12) |
+           (sharpRgb565To3bit(rgb[4]) << 9)  | (sharpRgb565To3bit(rgb[5]) << 6)  |
+           (sharpRgb565To3bit(rgb[6]) << 3)  |  sharpRgb565To3bit(rgb[7]);
+
+    hasChanged |= sharpStoreColorBits(data, bits);
+  }
+
+  return hasChanged;
+}
+
+// Copies 50 bytes of 1-bit data into a line, returns 1 if the line changed.
+// In color mode each pixel is sent as black or white (3 equal bits).
+static inline int sharpPackBitsLine(struct sharpCore *core, int y, const unsigned char *packed) {
+  unsigned char *data = sharpShadowLine(core, y) + 2;
+  int x, i, hasChanged = 0;
+  u32 bits;
+
+  if(!core->colorMode) {
+    if(!memcmp(data, packed, 50)) return 0;
+    memcpy(data, packed, 50);
+    return 1;
+  }
+
+  for(x=0 ; x<50 ; x++, data += 3) {
+    for(i=0, bits=0 ; i<8 ; i++) bits = (bits << 3) | ((packed[x] & (0x80 >> i)) ? 7 : 0);
+    hasChanged |= sharpStoreColorBits(data, bits);
+  }
+
+  return hasChanged;
+}
+
+// Dithers one 8-bit gray line with a 4x4 Bayer matrix, returns 1 if the line changed
+static inline int sharpPackGreyLine(struct sharpCore *core, int y, const u8 *grey) {
+  const u8 *threshold = sharpBayer4x4[y & 3];
+  unsigned char packed[50];
+  int x, i;
+
+  for(x=0 ; x<50 ; x++) {
+    packed[x] = 0;
+    for(i=0 ; i<8 ; i++) {
+      if(grey[x*8 + i] >= threshold[i & 3]) packed[x] |= (1 << (7 - i));
+    }
+  }
+
+  return sharpPackBitsLine(core, y, packed);
+}
+
+// Scans a whole framebuffer (8bpp, or RGB565 in color mode) and sends the
+// lines that changed. Returns the number of lines sent.
+static inline int sharpUpdateFb(struct sharpCore *core, const void *fb) {
+  int y, changed, sent = 0;
+
+  for(y=0 ; y < SHARP_HEIGHT ; y++) {
+    if(core->colorMode) changed = sharpPackColorLine(core, y, (const u16 *)fb + y*SHARP_WIDTH);
+    else changed = sharpPackMonoLine(core, y, (const u8 *)fb + y*SHARP_WIDTH);
+
+    if(changed) {
+      sharpSendLine(core, y);
+      sent++;
+    }
+  }
+
+  return sent;
+}
+
+#endif
@@ -0,0 +1,968 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+// Offline bench for snag's conversion pipeline.
+//
+// Replays RGB565 frame sequences through every dither method on every code
+// path: the scalar row kernel, the SIMD kernel when the CPU has one, and
+// worker threads. It reports the time to scale and convert each frame and
+// how many output pixels changed. Every path must give the scalar path's
+// output frame for frame. For the synthetic sequences, the scalar path's
+// frame GOLDEN_FRAME must also match a golden 1bpp image in bench/golden.
+// The SIMD pixel format readers must give the scalar readers' pixels.
+//
+// Recordings are raw RGB565 frames of any size (e.g. cat /dev/fb0, or
+// ffmpeg -pix_fmt rgb565le -f rawvideo), scaled to the panel like snag
+// does. Nothing here needs dispmanx, DRM or a framebuffer.
+//
+// Build with "make snag_bench".
+
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../capture.h"
+#include "../convert.h"
+#include "../dither.h"
+#include "../luma.h"
+#include "../pack.h"
+#include "../pixelFormat.h"
+#include "../scale.h"
+
+//-------------------------------------------------------------------------
+
+#define PANEL_WIDTH 400
+#define PANEL_HEIGHT 240
+#define DEFAULT_FRAMES 120
+#define GOLDEN_FRAME 120        // the frame the golden images show
+#define DEFAULT_THREADS 4
+#define MAX_REPLAYS 16
+#define READER_PIXELS 403       // longest row the readers are checked on
+
+#ifndef SNAG_BENCH_GOLDEN_DIR
+#define SNAG_BENCH_GOLDEN_DIR "bench/golden"
+#endif
+
+#define ALIGN_TO_16(x)  ((x + 15) & ~15)
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+
+    // draws a whole frame of a synthetic sequence, NULL for a recording
+    void
+    (*draw)(
+        uint16_t *pixels,
+        uint32_t pitch,
+        uint32_t frame);
+
+    const char *path;
+} Sequence;
+
+typedef enum
+{
+    PATH_SCALAR,
+    PATH_SIMD,
+    PATH_THREADS,
+    PATHS
+} Path;
+
+static const char *pathNames[PATHS] = { "scalar", "simd", "threads" };
+
+typedef struct
+{
+    uint32_t frames;
+    uint64_t scaleNs;
+    uint64_t convertNs;
+    uint64_t changedPixels;
+    uint64_t *hashes;           // of the output of each frame
+    uint8_t *output;
+    uint8_t *golden;            // frame GOLDEN_FRAME, NULL if not reached
+} Result;
+
+//-------------------------------------------------------------------------
+
+// Synthetic sequences, drawn from the frame number alone so every run
+// sees the same pixels.
+
+static uint32_t
+mix(
+    uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x7feb352d;
+    value ^= value >> 15;
+    value *= 0x846ca68b;
+    value ^= value >> 16;
+
+    return value;
+}
+
+//-------------------------------------------------------------------------
+
+static uint16_t
+rgb(
+    uint32_t red,
+    uint32_t green,
+    uint32_t blue)
+{
+    return ((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3);
+}
+
+//-------------------------------------------------------------------------
+
+// An 8x8 pseudo glyph, blank for glyph 0.
+
+static void
+drawCell(
+    uint16_t *pixels,
+    uint32_t pitch,
+    uint32_t x0,
+    uint32_t y0,
+    uint32_t glyph,
+    uint16_t foreground,
+    uint16_t background)
+{
+    for (uint32_t y = 0; y < 8; y++)
+    {
+        for (uint32_t x = 0; x < 8; x++)
+        {
+            bool on = (glyph != 0) &&
+                      (x < 6) &&
+                      (y < 7) &&
+                      ((glyph >> ((x * 7 + y) % 31)) & 1);
+
+            pixels[(y0 + y) * pitch + x0 + x] = on ? foreground : background;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static const uint16_t terminalColours[] =
+{
+    0xFFFF, 0xF800, 0x07E0, 0xFFE0, 0x001F, 0xF81F, 0x07FF, 0xC618
+};
+
+// One character typed per frame on a black terminal, with a cursor
+// blinking every 15 frames.
+
+static void
+drawTyping(
+    uint16_t *pixels,
+    uint32_t pitch,
+    uint32_t frame)
+{
+    uint32_t cells = (PANEL_WIDTH / 8) * (PANEL_HEIGHT / 8);
+    uint32_t cursor = frame % cells;
+
+    for (uint32_t cell = 0; cell < cells; cell++)
+    {
+        uint32_t glyph = (cell < cursor) ? (mix(cell) | 1) : 0;
+        uint16_t colour = terminalColours[mix(cell / 7) % 8];
+
+        if ((cell == cursor) && ((frame / 15) & 1))
+        {
+            glyph = 0xFFFFFFFF;
+            colour = 0xFFFF;
+        }
+
+        drawCell(pixels,
+                 pitch,
+                 (cell % (PANEL_WIDTH / 8)) * 8,
+                 (cell / (PANEL_WIDTH / 8)) * 8,
+                 glyph,
+                 colour,
+                 0x0000);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Dark text on a white page scrolling up 2 pixels per frame, like a
+// browser or a pager.
+
+static void
+drawScroll(
+    uint16_t *pixels,
+    uint32_t pitch,
+    uint32_t frame)
+{
+    for (uint32_t y = 0; y < PANEL_HEIGHT; y++)
+    {
+        uint32_t line = y + frame * 2;
+        uint32_t textRow = line / 10;
+        uint32_t cellY = line % 10;
+        uint32_t length = mix(textRow) % (PANEL_WIDTH / 8);
+        uint16_t colour = (mix(textRow) & 0x100) ? 0x001F : 0x0000;
+
+        for (uint32_t x = 0; x < PANEL_WIDTH; x++)
+        {
+            uint32_t column = x / 8;
+            uint32_t glyph = mix(textRow * 64 + column);
+            bool on = (cellY < 7) &&
+                      (column < length) &&
+                      ((glyph & 7) != 0) &&
+                      ((x % 8) < 6) &&
+                      ((glyph >> (((x % 8) * 7 + cellY) % 31)) & 1);
+
+            pixels[y * pitch + x] = on ? colour : 0xFFFF;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// A 2D game at twice the panel size (the 2x scaler): a scrolling tiled
+// background, moving sprites and a score line.
+
+static void
+drawGame(
+    uint16_t *pixels,
+    uint32_t pitch,
+    uint32_t frame)
+{
+    uint32_t width = 2 * PANEL_WIDTH;
+    uint32_t height = 2 * PANEL_HEIGHT;
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint32_t tileX = (x + frame) / 32;
+            uint32_t tileY = y / 32;
+            uint32_t shade = 64 + (tileY * 10) + ((tileX + tileY) & 1) * 40;
+
+            pixels[y * pitch + x] = rgb(shade / 2, shade, 255 - shade);
+        }
+    }
+
+    for (uint32_t sprite = 0; sprite < 6; sprite++)
+    {
+        uint32_t phase = frame * (3 + sprite) + sprite * 97;
+        uint32_t sx = 40 + (phase * 5) % (width - 128);
+        uint32_t sy = 60 + (phase * 3 + sprite * 50) % (height - 160);
+        uint16_t colour = rgb(255, 64 * (sprite % 4), 32 * sprite);
+
+        for (uint32_t y = 0; y < 48; y++)
+        {
+            for (uint32_t x = 0; x < 48; x++)
+            {
+                if (((x / 8) + (y / 8) + sprite) % 3 != 0)
+                {
+                    pixels[(sy + y) * pitch + sx + x] = colour;
+                }
+            }
+        }
+    }
+
+    // score, 2x2 pixel glyphs changing every frame
+    for (uint32_t digit = 0; digit < 8; digit++)
+    {
+        uint32_t glyph = mix((frame >> (digit * 2)) * 8 + digit) | 1;
+
+        for (uint32_t y = 0; y < 16; y++)
+        {
+            for (uint32_t x = 0; x < 16; x++)
+            {
+                bool on = ((x / 2) < 6) &&
+                          ((y / 2) < 7) &&
+                          ((glyph >> (((x / 2) * 7 + (y / 2)) % 31)) & 1);
+
+                pixels[(8 + y) * pitch + 600 + digit * 20 + x] = on ? 0xFFFF : 0x0000;
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static uint32_t
+triangle(
+    uint32_t value)
+{
+    int32_t phase = (int32_t)(value & 511) - 256;
+
+    return (phase < 0) ? -phase : phase;
+}
+
+// Smooth gradients with grain moving under every pixel, the worst case
+// for the row skipping and for error diffusion.
+
+static void
+drawVideo(
+    uint16_t *pixels,
+    uint32_t pitch,
+    uint32_t frame)
+{
+    for (uint32_t y = 0; y < PANEL_HEIGHT; y++)
+    {
+        for (uint32_t x = 0; x < PANEL_WIDTH; x++)
+        {
+            uint32_t grain = mix((frame * PANEL_HEIGHT + y) * PANEL_WIDTH + x) & 15;
+            uint32_t red = triangle(x * 2 + frame * 5) * 15 / 16 + grain;
+            uint32_t green = triangle(y * 3 + x + frame * 3) * 15 / 16 + grain;
+            uint32_t blue = triangle(x + y + frame * 7) * 15 / 16 + grain;
+
+            pixels[y * pitch + x] = rgb(red < 256 ? red : 255,
+                                        green < 256 ? green : 255,
+                                        blue < 256 ? blue : 255);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static uint64_t
+nanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+//-------------------------------------------------------------------------
+
+static uint64_t
+hashOutput(
+    const uint8_t *output)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (uint32_t i = 0; i < PANEL_WIDTH * PANEL_HEIGHT; i++)
+    {
+        hash = (hash ^ output[i]) * 0x100000001b3;
+    }
+
+    return hash;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+freeResult(
+    Result *result)
+{
+    free(result->hashes);
+    free(result->output);
+    free(result->golden);
+    memset(result, 0, sizeof(Result));
+}
+
+//-------------------------------------------------------------------------
+
+// Runs a sequence through one method on one path, the way snag's main loop
+// does. Returns false if the sequence cannot be read or memory runs out.
+
+static bool
+runPath(
+    const Sequence *sequence,
+    const DitherMethod *method,
+    Path path,
+    uint32_t frames,
+    uint32_t threads,
+    Result *result)
+{
+    uint32_t sourcePitch = ALIGN_TO_16(sequence->width);
+    bool scaled = (sequence->width != PANEL_WIDTH) ||
+                  (sequence->height != PANEL_HEIGHT);
+    size_t panelPixels = PANEL_WIDTH * PANEL_HEIGHT;
+
+    Scaler *scaler = NULL;
+    Capture *capture = NULL;
+    uint16_t *source = malloc(sourcePitch * sequence->height * sizeof(uint16_t));
+    uint16_t *newPixels = malloc(panelPixels * sizeof(uint16_t));
+    uint16_t *oldPixels = malloc(panelPixels * sizeof(uint16_t));
+    uint8_t *previous = calloc(panelPixels, 1);
+    bool ok = false;
+
+    memset(result, 0, sizeof(Result));
+    result->hashes = calloc(frames, sizeof(uint64_t));
+    result->output = calloc(panelPixels, 1);
+
+    Converter converter =
+    {
+        .width = PANEL_WIDTH,
+        .height = PANEL_HEIGHT,
+        .srcPitch = PANEL_WIDTH,
+        .dstPitch = PANEL_WIDTH,
+        .ditherRow = (path == PATH_SCALAR) ? method->row : selectDitherKernel(method, true)
+    };
+
+    if (method->diffusion != DIFFUSION_NONE)
+    {
+        converter.diffuser = createDiffuser(method->diffusion, PANEL_WIDTH, PANEL_HEIGHT);
+    }
+
+    if (scaled)
+    {
+        scaler = createScaler(sequence->width, sequence->height, PANEL_WIDTH, PANEL_HEIGHT);
+    }
+
+    if (sequence->path != NULL)
+    {
+        const char *error = NULL;
+        char spec[PATH_MAX + 32];
+
+        snprintf(spec, sizeof(spec), "file:%ux%u:%s", sequence->width, sequence->height, sequence->path);
+        capture = openCapture(spec, 0, &error);
+
+        if (capture == NULL)
+        {
+            fprintf(stderr, "%s: %s: %s\n", sequence->path, error, strerror(errno));
+        }
+    }
+
+    if (!initConverter(&converter) ||
+        (source == NULL) ||
+        (newPixels == NULL) ||
+        (oldPixels == NULL) ||
+        (previous == NULL) ||
+        (result->hashes == NULL) ||
+        (result->output == NULL) ||
+        ((method->diffusion != DIFFUSION_NONE) && (converter.diffuser == NULL)) ||
+        (scaled && (scaler == NULL)) ||
+        ((sequence->path != NULL) && (capture == NULL)))
+    {
+        goto done;
+    }
+
+    if (path == PATH_THREADS)
+    {
+        converter.workers = createWorkers(threads, PANEL_HEIGHT, method->period);
+
+        if (converter.workers == NULL)
+        {
+            goto done;
+        }
+    }
+
+    memset(oldPixels, 1, panelPixels * sizeof(uint16_t));
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        uint16_t *input = scaled ? source : newPixels;
+        uint32_t inputPitch = scaled ? sourcePitch : PANEL_WIDTH;
+
+        if (capture != NULL)
+        {
+            if (!capture->grab(capture, input, scaled ? source : oldPixels, inputPitch))
+            {
+                break;
+            }
+        }
+        else
+        {
+            sequence->draw(input, inputPitch, frame);
+        }
+
+        if (scaled)
+        {
+            uint64_t start = nanoseconds();
+            scaleFrame(scaler, source, sourcePitch, newPixels, oldPixels, PANEL_WIDTH);
+            result->scaleNs += nanoseconds() - start;
+        }
+
+        uint64_t start = nanoseconds();
+        convertFrame(&converter, newPixels, oldPixels, result->output);
+        result->convertNs += nanoseconds() - start;
+
+        for (size_t i = 0; i < panelPixels; i++)
+        {
+            result->changedPixels += (result->output[i] != previous[i]);
+        }
+
+        memcpy(previous, result->output, panelPixels);
+
+        if ((frame + 1 == GOLDEN_FRAME) &&
+            ((result->golden = malloc(panelPixels)) != NULL))
+        {
+            memcpy(result->golden, result->output, panelPixels);
+        }
+        result->hashes[frame] = hashOutput(result->output);
+        result->frames = frame + 1;
+
+        uint16_t *swap = oldPixels;
+        oldPixels = newPixels;
+        newPixels = swap;
+    }
+
+    ok = true;
+
+done:
+
+    freeConverter(&converter);
+    destroyScaler(scaler);
+    closeCapture(capture);
+    free(source);
+    free(newPixels);
+    free(oldPixels);
+    free(previous);
+
+    if (!ok)
+    {
+        freeResult(result);
+    }
+
+    return ok;
+}
+
+//-------------------------------------------------------------------------
+
+// The output as a binary PBM image (P4), where a set bit is black.
+
+static uint8_t *
+makePbm(
+    const uint8_t *output,
+    size_t *size)
+{
+    char header[32];
+    int headerSize = snprintf(header, sizeof(header), "P4\n%d %d\n", PANEL_WIDTH, PANEL_HEIGHT);
+    uint32_t rowBytes = PANEL_WIDTH / 8;
+
+    *size = headerSize + rowBytes * PANEL_HEIGHT;
+
+    uint8_t *pbm = malloc(*size);
+
+    if (pbm == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(pbm, header, headerSize);
+
+    uint8_t *bits = pbm + headerSize;
+
+    for (uint32_t i = 0; i < rowBytes * PANEL_HEIGHT; i++)
+    {
+        bits[i] = packEight(output + i * 8) ^ 0xFF;
+    }
+
+    return pbm;
+}
+
+//-------------------------------------------------------------------------
+
+// Compares the output with the golden image of a sequence and method, or
+// writes it if update is set. Returns a status for the report.
+
+static const char *
+checkGolden(
+    const char *directory,
+    const Sequence *sequence,
+    const DitherMethod *method,
+    const uint8_t *output,
+    bool update,
+    bool *failed)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s-%s.pbm", directory, sequence->name, method->name);
+
+    size_t size = 0;
+    uint8_t *pbm = makePbm(output, &size);
+    const char *status = "golden ok";
+
+    if (pbm == NULL)
+    {
+        *failed = true;
+        return "out of memory";
+    }
+
+    FILE *fp = fopen(path, update ? "wb" : "rb");
+
+    if (fp == NULL)
+    {
+        *failed = true;
+        status = update ? "CANNOT WRITE GOLDEN" : "NO GOLDEN";
+    }
+    else if (update)
+    {
+        status = (fwrite(pbm, size, 1, fp) == 1) ? "golden written" : "CANNOT WRITE GOLDEN";
+        *failed |= (fclose(fp) != 0);
+        fp = NULL;
+    }
+    else
+    {
+        uint8_t *golden = malloc(size + 1);
+
+        if ((golden == NULL) ||
+            (fread(golden, 1, size + 1, fp) != size) ||
+            (memcmp(golden, pbm, size) != 0))
+        {
+            *failed = true;
+            status = "GOLDEN MISMATCH";
+        }
+
+        free(golden);
+    }
+
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+
+    free(pbm);
+
+    return status;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+printResult(
+    const Sequence *sequence,
+    const DitherMethod *method,
+    Path path,
+    const Result *result,
+    const char *status)
+{
+    double frames = (result->frames > 0) ? result->frames : 1;
+
+    printf("%-10s %-16s %-8s %6u %12.0f %14.0f %14.1f   %s\n",
+           sequence->name,
+           method->name,
+           pathNames[path],
+           result->frames,
+           result->scaleNs / frames,
+           result->convertNs / frames,
+           result->changedPixels / frames,
+           status);
+}
+
+//-------------------------------------------------------------------------
+
+// Returns the number of failed checks.
+
+static int
+benchSequence(
+    const Sequence *sequence,
+    const char *methodName,
+    uint32_t frames,
+    uint32_t threads,
+    const char *goldenDirectory,
+    bool updateGolden)
+{
+    int failures = 0;
+    const DitherMethod *method;
+
+    for (size_t m = 0; (method = ditherMethodAt(m)) != NULL; m++)
+    {
+        if ((methodName != NULL) && (strcmp(methodName, method->name) != 0))
+        {
+            continue;
+        }
+
+        Result reference;
+
+        if (!runPath(sequence, method, PATH_SCALAR, frames, threads, &reference))
+        {
+            fprintf(stderr, "cannot run %s with %s\n", sequence->name, method->name);
+            return failures + 1;
+        }
+
+        bool failed = false;
+        const char *status = "reference";
+
+        if ((sequence->draw != NULL) && (reference.golden != NULL))
+        {
+            status = checkGolden(goldenDirectory,
+                                 sequence,
+                                 method,
+                                 reference.golden,
+                                 updateGolden,
+                                 &failed);
+        }
+
+        failures += failed;
+        printResult(sequence, method, PATH_SCALAR, &reference, status);
+
+        for (Path path = PATH_SIMD; path < PATHS; path++)
+        {
+            // diffusion has neither; a method without a SIMD kernel would
+            // just repeat the scalar run
+            if ((method->diffusion != DIFFUSION_NONE) ||
+                ((path == PATH_SIMD) && (neonDitherKernel(method->name) == NULL)))
+            {
+                continue;
+            }
+
+            Result result;
+
+            if (!runPath(sequence, method, path, frames, threads, &result))
+            {
+                fprintf(stderr, "cannot run %s with %s\n", sequence->name, method->name);
+                ++failures;
+                continue;
+            }
+
+            bool same = (result.frames == reference.frames) &&
+                        (memcmp(result.hashes,
+                                reference.hashes,
+                                reference.frames * sizeof(uint64_t)) == 0);
+
+            failures += !same;
+            printResult(sequence, method, path, &result, same ? "matches scalar" : "MISMATCH");
+            freeResult(&result);
+        }
+
+        freeResult(&reference);
+    }
+
+    return failures;
+}
+
+//-------------------------------------------------------------------------
+
+// Reads random rows of every length up to READER_PIXELS, so each count
+// of pixels past the last whole SIMD step is covered, with the scalar
+// reader and the one snag would select. Returns the number of failed
+// checks.
+
+static int
+checkReaders(void)
+{
+    static const struct
+    {
+        const char *name;
+        PixelFormat format;
+    } checked[] =
+    {
+        { "xrgb8888", PIXEL_FORMAT_XRGB8888 },
+        { "xbgr8888", PIXEL_FORMAT_XBGR8888 },
+    };
+
+    uint8_t src[4 * (READER_PIXELS + 2)];
+    uint16_t expected[READER_PIXELS];
+    uint16_t actual[READER_PIXELS];
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(src); i++)
+    {
+        src[i] = mix(i);
+    }
+
+    for (size_t f = 0; f < sizeof(checked) / sizeof(checked[0]); f++)
+    {
+        PixelReader scalar = scalarPixelReader(checked[f].format);
+        PixelReader selected = selectPixelReader(checked[f].format);
+
+        if (selected == scalar)
+        {
+            continue;
+        }
+
+        bool same = true;
+
+        for (uint32_t count = 1; same && (count <= READER_PIXELS); count++)
+        {
+            // rows start at other than 16-byte boundaries too
+            const uint8_t *row = src + 4 * (count % 3);
+
+            scalar(row, expected, count, NULL);
+            selected(row, actual, count, NULL);
+            same = (memcmp(expected, actual, count * sizeof(uint16_t)) == 0);
+        }
+
+        failures += !same;
+        printf("%s reader: %s\n", checked[f].name, same ? "matches scalar" : "MISMATCH");
+    }
+
+    return failures;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+printUsage(
+    FILE *fp,
+    const char *name)
+{
+    fprintf(fp, "\n");
+    fprintf(fp, "Usage: %s <options>\n", name);
+    fprintf(fp, "\n");
+    fprintf(fp, "Options:\n");
+    fprintf(fp, "  --frames <n>              Frames per sequence (default %d)\n", DEFAULT_FRAMES);
+    fprintf(fp, "  --threads <n>             Threads for the threaded path (default %d)\n", DEFAULT_THREADS);
+    fprintf(fp, "  --method <name>           Only run one dither method\n");
+    fprintf(fp, "  --replay <w>x<h>:<file>   Replay raw RGB565 frames instead of the synthetic sequences (repeatable)\n");
+    fprintf(fp, "  --golden <directory>      Golden images (default %s)\n", SNAG_BENCH_GOLDEN_DIR);
+    fprintf(fp, "  --update-golden           Write the golden images instead of checking them\n");
+    fprintf(fp, "  --help                    Print usage and exit\n");
+}
+
+//-------------------------------------------------------------------------
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+    static const Sequence synthetic[] =
+    {
+        { "typing", PANEL_WIDTH, PANEL_HEIGHT, drawTyping, NULL },
+        { "scroll", PANEL_WIDTH, PANEL_HEIGHT, drawScroll, NULL },
+        { "game", 2 * PANEL_WIDTH, 2 * PANEL_HEIGHT, drawGame, NULL },
+        { "video", PANEL_WIDTH, PANEL_HEIGHT, drawVideo, NULL },
+    };
+
+    Sequence replays[MAX_REPLAYS];
+    size_t replayCount = 0;
+    uint32_t frames = DEFAULT_FRAMES;
+    uint32_t threads = DEFAULT_THREADS;
+    const char *methodName = NULL;
+    const char *goldenDirectory = SNAG_BENCH_GOLDEN_DIR;
+    bool updateGolden = false;
+
+    static const char *sopts = "f:t:m:r:g:uh";
+    static struct option lopts[] =
+    {
+        { "frames", required_argument, NULL, 'f' },
+        { "threads", required_argument, NULL, 't' },
+        { "method", required_argument, NULL, 'm' },
+        { "replay", required_argument, NULL, 'r' },
+        { "golden", required_argument, NULL, 'g' },
+        { "update-golden", no_argument, NULL, 'u' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, no_argument, NULL, 0 }
+    };
+
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, sopts, lopts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'f':
+            frames = (atoi(optarg) > 0) ? atoi(optarg) : DEFAULT_FRAMES;
+            break;
+
+        case 't':
+            threads = (atoi(optarg) > 1) ? atoi(optarg) : DEFAULT_THREADS;
+            break;
+
+        case 'm':
+            methodName = optarg;
+
+            if (findDitherMethod(methodName) == NULL)
+            {
+                fprintf(stderr, "%s: unknown dither method %s\n", argv[0], methodName);
+                return EXIT_FAILURE;
+            }
+
+            break;
+
+        case 'r':
+        {
+            Sequence *replay = &replays[replayCount];
+            int consumed = 0;
+
+            if ((replayCount == MAX_REPLAYS) ||
+                (sscanf(optarg, "%ux%u:%n", &replay->width, &replay->height, &consumed) != 2) ||
+                (consumed == 0) ||
+                (replay->width == 0) ||
+                (replay->height == 0))
+            {
+                fprintf(stderr, "%s: bad replay %s\n", argv[0], optarg);
+                printUsage(stderr, argv[0]);
+                return EXIT_FAILURE;
+            }
+
+            replay->path = optarg + consumed;
+            replay->draw = NULL;
+
+            const char *slash = strrchr(replay->path, '/');
+            replay->name = (slash != NULL) ? slash + 1 : replay->path;
+            ++replayCount;
+            break;
+        }
+
+        case 'g':
+            goldenDirectory = optarg;
+            break;
+
+        case 'u':
+            updateGolden = true;
+            break;
+
+        case 'h':
+            printUsage(stdout, argv[0]);
+            return EXIT_SUCCESS;
+
+        default:
+            printUsage(stderr, argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    buildLumaTable(1.0, 1.0);
+
+    printf("%u frames per sequence, %u threads on the threaded path, %s\n",
+           frames,
+           threads,
+           (neonDitherKernel("4x4") != NULL) ? "NEON kernels" : "no SIMD kernels on this CPU");
+
+    int failures = checkReaders();
+
+    printf("\n%-10s %-16s %-8s %6s %12s %14s %14s   %s\n",
+           "sequence",
+           "method",
+           "path",
+           "frames",
+           "scale ns/fr",
+           "convert ns/fr",
+           "changed px/fr",
+           "output");
+
+    if (replayCount > 0)
+    {
+        for (size_t i = 0; i < replayCount; i++)
+        {
+            failures += benchSequence(&replays[i], methodName, frames, threads, goldenDirectory, false);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < sizeof(synthetic) / sizeof(synthetic[0]); i++)
+        {
+            failures += benchSequence(&synthetic[i], methodName, frames, threads, goldenDirectory, updateGolden);
+        }
+    }
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
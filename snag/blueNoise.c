@@ -0,0 +1,395 @@
+// Generated by blueNoise.py, do not edit.
+
+#include <stdint.h>
+
+#include "dither.h"
+
+//-------------------------------------------------------------------------
+
+const uint8_t BLUE_NOISE64X64[64][64] =
+{
+    {
+        209,  47, 194,  65, 141,  31, 156,  43, 134,  24, 250, 103, 187, 243,  30,  74,
+        184, 121,  29, 216,  44, 124, 160, 231, 185, 215, 166, 233, 138,  22, 127,  10,
+        226, 133, 173, 238, 157,  30, 190,  13, 155, 230, 171, 115,  50,  91, 213, 113,
+        247,  78, 203,  35, 191,  19, 251, 149, 196,  89, 232, 180,   5, 194,  23,  65,
+    },
+    {
+        150,  87,  27, 234, 105, 215,  73, 229, 195,  91, 217,  65, 160,  88, 199, 110,
+         19, 231, 155, 102, 183, 237,  97,  61,  39, 123,  74, 112,  41, 214,  71, 102,
+        207,  46, 112,   1,  80, 227,  94, 245, 124,  71,  35, 147, 233, 196,  68,   1,
+        176,  55, 119, 159,  83, 208, 101,  36, 221, 129,  43, 101,  60, 131, 240, 117,
+    },
+    {
+          8, 245, 130, 162,  12, 180, 123,  17,  53, 171, 140,  39, 229,  12, 148, 221,
+         49, 202,  71, 137,  25, 205,   8, 172, 144, 224,  14, 199,  92, 154, 239, 179,
+         30, 151, 198,  61, 184, 141,  55, 174,  27, 195, 220, 101,  19, 130, 165, 100,
+        219, 141, 230,   7, 241,  53, 142, 184,  72,  15, 200, 252, 150, 170,  39, 184,
+    },
+    {
+         98, 171,  74, 219,  57,  88, 252, 149, 212, 115,   3, 206, 124,  57, 178, 132,
+         97, 167,   5, 255,  90,  53, 129, 247,  86, 191,  50, 253, 176,   6,  55, 121,
+         78, 252,  94, 223, 119,  38, 215, 111,  81, 138,  53, 179,  80, 244,  40, 191,
+         29,  89,  43, 106, 179, 126,  20, 229, 107, 171, 141,  28, 213,  92,  70, 224,
+    },
+    {
+         53, 203,  38, 112, 143, 204,  39, 103,  66, 244,  85, 185, 101, 251,  80,  35,
+        242,  60, 114, 173, 223, 152, 187,  68,  21, 104, 161,  68, 114, 144, 203, 225,
+        161,  11, 136,  25, 158, 241,  10, 151, 206, 251,   4, 158, 207,  59, 148, 122,
+        251, 168, 210, 151,  70, 217,  86, 161,  48, 238,  85,  54, 115,  13, 199, 127,
+    },
+    {
+        146, 228,  18, 188, 239,   8, 167, 190,  20, 160,  48, 146,  21, 162, 210,  14,
+        188, 149, 213,  41,  77, 109,  35, 212, 120, 236, 137,  32, 217,  83,  24, 103,
+         48, 193,  70, 206,  51, 100, 191,  63,  23,  96, 124, 228, 112,  16, 198,  77,
+          9,  68, 128,  18, 197,  34, 253, 118,   4, 189, 126, 223, 181, 247, 159,  24,
+    },
+    {
+         83, 117, 160,  95,  50, 129,  75, 236, 118, 201, 221,  70, 236,  44, 127, 108,
+        233,  84,  18, 126, 201,  10, 232, 159,  49, 203,   3, 189, 240,  44, 181, 133,
+        235, 170, 115, 246, 174,  81, 133, 237, 161, 188,  67,  35,  87, 175, 234,  99,
+        218, 180,  49, 243, 100, 165,  62, 144, 212,  69,  26, 152,  77,  45, 101, 238,
+    },
+    {
+        190,  41, 254,  69, 177, 229,  99,  42, 140,  89,  29, 131, 193,  91, 181,  64,
+        140,  47, 176, 241, 143, 182,  72, 131,  92, 170,  74,  99, 124, 160, 213,  65,
+         15,  90,  32, 142,   4, 227,  40, 112,  28, 224, 134, 154, 248,  49, 134,  23,
+        154, 112, 228,  80, 133, 186,  19,  95, 168, 246, 104, 206,   6, 138, 177,  62,
+    },
+    {
+        212, 139,   2, 206, 147,  21, 212, 159,   5, 243, 176, 109,  16, 217, 152,   1,
+        202, 224,  94,  59,  31, 100, 252,  20, 222,  40, 245, 150,  57,  10,  94, 250,
+        154, 198, 224, 106,  64, 155, 203, 177,  90,  48, 203,  13, 212, 115, 169,  61,
+        205,  32, 146,   3, 213,  44, 237, 196,  51, 133,  38, 164, 234, 114, 219,  16,
+    },
+    {
+        122,  77, 172, 109,  38, 122, 184,  53, 198,  76, 149,  56, 253,  74,  38, 240,
+        102,  25, 156, 119, 211, 169,  53, 150, 186, 118,  17, 180, 228, 200, 118,  41,
+        128,  76,  50, 182, 215, 123,  18,  73, 255, 120, 166,  99,  73,  29, 194,  83,
+        254,  95, 190,  65, 159, 103, 126,  77,  12, 226,  89, 198,  58,  86,  36, 158,
+    },
+    {
+        232,  46, 241,  88, 224,  64, 250,  90, 113, 225,  37, 203, 134, 167, 115, 187,
+        135,  69, 191, 246,  82,   4, 202, 105,  65, 210,  86, 135,  34,  79, 167, 189,
+         20, 233, 163,  13,  91, 235,  52, 138, 215,   2,  61, 181, 243, 145, 227,   6,
+        138,  48, 225, 123, 248,  22, 170, 219, 150, 183, 120,  24, 148, 251, 187,  98,
+    },
+    {
+         20, 192, 144,  14, 179, 154,  10, 136, 166,  18, 178,  97,   7, 227,  86,  53,
+        163, 221,  14,  44, 147, 227, 129,  30, 238, 142,  50, 255, 107, 216,  57, 244,
+        101, 139, 206, 117,  37, 151, 175,  99, 190, 148, 236,  22, 127,  43, 101, 184,
+        118, 164,  15, 178,  86,  57, 200,  33, 109,  55, 237,  73, 178,  10, 135,  67,
+    },
+    {
+        164, 104,  60, 203, 115,  79, 216,  40, 240,  69, 123, 214,  65, 192,  24, 245,
+         33,  92, 129, 178, 111,  64, 166,  87, 176,   7, 195, 163,  22, 131,   1, 153,
+         65,  30,  80, 252, 192,  70, 242,  25,  43,  78, 110, 199,  87, 217, 159,  59,
+        242,  75, 216,  40, 112, 235, 138,  92, 255,   1, 163, 213, 126,  50, 202, 221,
+    },
+    {
+         38, 250, 129,  29, 233,  48, 189, 104, 197, 144, 231,  45, 161, 125, 149, 209,
+        119, 195, 236,  77, 213,  17, 250,  43, 219, 117,  72,  94, 226, 179, 202, 114,
+        218, 181, 158,  54, 134,   5, 113, 207, 131, 224, 157,  37, 174,  69,  13, 195,
+         32,  98, 141, 202, 154,   8, 187,  67, 205, 142,  82,  39, 102, 243,  79, 116,
+    },
+    {
+        184,  83, 211, 149,  93, 168, 128,  22,  57,  89,  25, 106, 248,  13,  99,  64,
+        169,   5,  55, 159,  33, 183, 139, 100, 153,  24, 208, 147,  33,  62,  85,  43,
+        240,  95,  12, 216,  98, 225, 161,  85, 179,  64,   7, 233, 139, 250, 113, 143,
+        229, 172,  18,  66, 224,  49, 123, 162,  20, 115, 223, 191,  17, 167, 144,   4,
+    },
+    {
+         54, 155,  15,  68, 246,   1, 224, 152, 255, 166, 185, 208,  78, 177, 233,  37,
+         88, 254, 143, 105, 230,  81, 204,  61, 238, 178,  56, 247, 122, 232, 167, 139,
+         26, 127, 198, 145,  34, 185,  56,  19, 252, 104, 205,  54,  97,  28, 203,  49,
+         86, 122, 252, 105, 177,  85, 246,  37, 231, 178,  53, 132, 234,  63, 195, 224,
+    },
+    {
+        106, 239, 177, 120, 185,  55, 110,  76, 212,   7, 118,  42, 148,  55, 132, 185,
+        216, 116,  25, 193,  46, 131,   3, 119,  36,  90, 134,  18, 196, 102,  10, 206,
+        175,  71,  47, 246,  79, 116, 235, 139,  39, 149, 169, 125, 188,  76, 162, 221,
+          2, 183,  42, 135,  26, 146, 194, 106,  70,  96,  27, 157, 107,  34,  88, 130,
+    },
+    {
+        201,  30,  97,  42, 217, 140, 193,  36, 101,  65, 138, 223,  19, 200, 107,  11,
+        150,  69, 207,  84, 162, 246, 175, 214, 156, 223, 189,  79,  47, 151,  66, 253,
+         92, 228, 121, 167,  16, 155, 199,  95, 217,  68,  26, 220,  11, 239, 128,  63,
+        149, 199,  76, 235, 211,  62,   4, 217, 139, 199, 247,  74, 215, 178, 252,  19,
+    },
+    {
+         71, 138, 226, 163,  82,  26, 244, 172, 147, 195, 240,  88, 163, 246,  80, 226,
+         51, 170, 239,  12, 108,  62,  31,  96,  69,  11, 107, 240, 176, 222, 116,  34,
+        154,   4, 192, 104, 222,  45,  71,   3, 190, 114, 243,  86, 109, 177,  38,  98,
+        247, 112,  22, 156,  93, 184, 116, 160,  47,  17, 169, 125,   8, 141,  50, 161,
+    },
+    {
+        237, 187,  57,  13, 203, 129,  91,  11, 218,  50,  27, 111,  58, 128,  38, 194,
+        136,  30, 122, 184, 144, 225, 199, 126, 254, 168,  41, 139,  15,  86, 197, 133,
+         54, 217,  67,  28, 176, 137, 249, 127, 171,  48, 155, 200,  57, 145, 204,  16,
+        174,  55, 206, 126,  46, 232,  32, 245,  88, 222, 105,  59, 202,  95, 220, 112,
+    },
+    {
+          4,  86, 117, 252, 151,  63, 226, 118,  72, 132, 168, 188, 213,   7, 174, 101,
+        250,  87,  58, 231,  40,  80,   8, 147,  54, 193, 121, 211,  59, 165,  25, 234,
+        183,  95, 130, 238,  82, 212, 100,  33, 228,  81,   9, 133,  28, 234,  74, 223,
+        136,  85, 242,   7, 166,  77, 132, 177,  62, 142, 185,  34, 231,  77, 173,  39,
+    },
+    {
+        154, 208, 175,  33, 103, 186,  42, 160, 200, 249,  15,  83, 140, 238,  71, 151,
+         19, 215, 167,  97, 195, 117, 177, 213,  84,  25, 230,  94, 145, 247, 107,  73,
+        162,  39, 204, 152,  52,  11, 165,  63, 143, 208, 184, 253, 100, 168, 115,  49,
+        160,  31, 180, 108, 220, 200,  21, 104, 205,   5, 254, 159, 134,  15, 195, 127,
+    },
+    {
+        246,  49, 140,  75, 213,   6, 241,  95,  30, 106,  62, 223,  41, 116, 201,  53,
+        189, 127,   1, 143,  26, 249,  48, 103, 238, 157,  72,   2, 182,  44, 203,   9,
+        120, 244,  22, 110, 188, 123, 201, 236, 107,  20, 119,  68,  40, 213,   3, 195,
+         93, 229,  67, 143,  92,  57, 150, 237,  42, 123,  74,  98,  52, 238, 103,  66,
+    },
+    {
+        220,  92,  15, 237, 128, 165,  60, 143, 179, 231, 147, 194,  96, 161,  23, 225,
+        107,  76, 243, 204,  63, 130, 164,  19, 137,  42, 174, 111, 227, 129,  88, 222,
+        143,  60, 172,  78, 255,  42,  88,  27, 176,  56, 224, 156, 181,  86, 147, 249,
+        128,  13, 191,  40, 253,  10, 186,  83, 161, 219, 193,  27, 169, 204, 144,  21,
+    },
+    {
+        165, 113, 202, 179,  39, 112, 217,  81,  10, 122,  35, 171,   3, 255,  88, 141,
+         36, 180,  51, 156,  93, 211,  74, 224, 192,  91, 251, 208,  27,  66, 167,  37,
+        192,  92, 207,   1, 147, 219, 130, 159, 248,  96, 136,  13, 238, 123,  23,  59,
+        170, 110, 210, 155, 113, 133, 217,  64, 110,  12, 138, 242, 119,  81,  43, 187,
+    },
+    {
+         76,  31, 147,  63,  97, 192,  23, 251, 197,  59, 214,  76, 135, 205,  60, 236,
+        163, 219, 119,  31, 236,   9, 178, 116,  60,  11, 126,  52, 152, 196, 249, 111,
+         18, 159, 226, 107,  59, 181,  13,  73, 198,  32, 216,  78,  47, 198, 217,  81,
+        235,  46,  75,  26, 234,  47, 169,  22, 247, 176,  46,  68, 212,   1, 227, 129,
+    },
+    {
+         52, 209, 254,   4, 220, 142,  51, 128, 158, 102, 244, 112,  45, 179, 122,  28,
+         98,   7,  79, 192, 135, 108,  43, 243, 148, 199, 167,  82, 103,   6, 133,  79,
+        237,  48, 124,  31, 240,  84, 212, 118,  51, 145, 185, 115, 172, 100, 153,  33,
+        185, 144, 223, 165,  87, 191, 100, 130, 201,  89, 153, 108, 183, 160,  95, 241,
+    },
+    {
+        175, 123,  85, 167,  72, 239, 175,  90,  32, 182,  18, 149, 230,  14,  82, 190,
+        211, 146, 251, 171,  55, 203, 161,  26,  96, 222,  31, 237, 186, 213,  55, 179,
+        141, 201,  70, 189, 135, 167,  40, 155, 235,  89,   7, 241,  28,  66, 245, 118,
+         90,  15, 104, 200,   2,  67, 238,  33,  56, 228,  20, 220,  34,  59, 144,  17,
+    },
+    {
+        102,  25, 193, 135,  35, 116,   9, 209, 236,  52,  85, 198,  67, 158, 247, 135,
+         37,  65, 103,  14, 227,  90,  69, 211, 134,  75,  48, 138,  24, 117, 228,  30,
+        100,  16, 154, 229,  10, 101, 246,  19, 175,  62, 202, 134, 161, 192,   4, 138,
+        208, 252,  56, 137, 116, 214, 144, 163, 113, 187, 133,  84, 249, 120, 194, 218,
+    },
+    {
+        158, 245,  56, 223, 100, 198, 150,  69, 125, 155, 226, 117,  34, 214, 107,  52,
+        176, 231, 160, 123,  35, 140, 247,   4, 186, 113, 248, 172,  90, 155,  73, 166,
+        207, 244,  87, 114,  54, 200,  74, 130, 109, 225,  97,  41,  77, 215,  50, 168,
+         70,  28, 177, 229,  38, 180,  17,  79, 254,   5,  66, 202, 164,   9,  73,  45,
+    },
+    {
+         80, 114, 147,  14, 173,  50, 249,  27, 104, 191,   1, 139, 174,  91,   8, 204,
+        114,  23,  82, 218, 196, 169, 105,  52, 163,  18, 196,  62, 217,  10, 252,  43,
+        122,  61, 182,  36, 173, 143, 214,  45, 191,  26, 153, 254, 128, 108, 228,  95,
+        194, 123, 151,  73,  97, 240,  54, 198,  99, 174, 150,  48, 106, 210, 137, 233,
+    },
+    {
+        183,  21, 201,  71, 230,  84, 129, 176, 222,  44,  78, 253,  56, 232, 153,  70,
+        244, 140, 183,  50,  74,  25, 234, 128, 215,  85, 147,  36, 105, 131, 195,  98,
+        150,   5, 221, 125, 253,  93,   3, 232, 145,  58, 206,   9, 178,  31, 146,  16,
+        238,  44, 210,   9, 164, 118, 137, 221,  42, 123, 230,  27, 240,  89, 172,  32,
+    },
+    {
+        214,  95, 239, 122, 157,  34, 216,  12,  91, 164, 201, 111,  19, 184, 128,  31,
+        194,  93,  16, 255, 148,  92, 188,  65,  32, 232, 121, 205, 239,  52, 174,  23,
+        237, 191,  75, 157,  21,  63, 182, 115,  84, 172, 105,  69, 232,  88, 188,  64,
+        163, 110,  90, 248, 190,  22,  84, 159,  25, 189,  77, 140, 179,  17,  63, 125,
+    },
+    {
+         44, 162,  58,   3, 195, 102, 146,  66, 236, 132,  30, 144, 210,  80, 104, 217,
+         54, 164, 127, 209, 111,   6, 219, 156, 101, 179,  73,   1, 156,  82, 218,  70,
+        135,  94,  33, 215, 105, 236, 153,  38, 243,  14, 219, 124, 159,  52, 248, 132,
+        213,  26, 144,  65,  41, 232, 201,  67, 245,  95, 208,  58, 111, 220, 153, 251,
+    },
+    {
+        113, 190, 142,  89, 255,  54, 184, 207, 113,  55, 243,  68, 162,  43, 242, 171,
+          2, 232,  72,  35, 166, 239,  45, 137,  23, 253,  50, 140, 185,  29, 120, 166,
+         48, 226, 170, 139,  50, 192, 125,  72, 199, 136,  44, 189,  19, 207, 116,   7,
+         81, 186, 222, 173, 132, 105, 148,  16, 117, 169,   2, 249,  37, 196,  93,   7,
+    },
+    {
+         78, 231,  35, 209, 167,  17, 126,  32, 171,   5, 187, 101, 227,  11, 140,  64,
+        114, 151,  99, 201,  60, 124, 183,  71, 208, 165, 114, 226,  93, 247, 199,  14,
+        241, 110,   8, 204,  82,  16, 225,  26, 158,  91, 250,  76, 148,  98,  41, 170,
+        240,  54, 117,   3,  78, 211,  53, 180, 226,  46, 150, 121, 165,  67, 134, 180,
+    },
+    {
+        204,  18, 131,  69, 111, 230,  80, 245,  96, 150, 218,  27, 126, 198,  91, 189,
+        214,  23, 244, 179,  12,  87, 216, 110,   8,  86, 197,  20,  45, 107,  61, 146,
+         89, 185,  68, 120, 248, 173,  95, 187,  53, 209, 112,  28, 229, 180, 218, 139,
+        104,  33, 153, 254, 188,  29, 242,  98, 136,  71, 193,  81, 229,  24, 243,  51,
+    },
+    {
+        163, 100, 245, 151,  42, 194, 156,  48, 211,  72, 136,  84, 174,  56, 252,  37,
+        130,  80,  47, 134, 156, 250,  33, 151, 235, 131,  63, 149, 220, 168, 128, 214,
+         24, 157, 220,  38, 152,  61, 141, 115, 234,   1, 176, 133,  51,  84,  14,  64,
+        197, 231,  93,  62, 126, 158,  81,  10, 204,  32, 221,  14, 101, 206, 151, 119,
+    },
+    {
+        220,  61, 182,  24, 222,  98,   8, 129, 185,  21, 249,  39, 230, 112,  14, 157,
+        181, 229, 109, 208,  67, 103, 194,  54, 174,  39, 248, 184,  75,   5, 192,  41,
+        255,  56, 133, 100, 230,   7, 210,  36,  79, 153,  63, 239, 195, 158, 251, 122,
+        162,  22, 177, 210,  42, 224, 118, 173, 238, 108, 161, 132, 183,  42,  87,  13,
+    },
+    {
+         38, 129,  85, 207, 120,  73, 175, 227,  61, 118, 195, 153,  67, 142, 220, 101,
+         69,   5, 168,  30, 231,  15, 141,  79, 221,  95,  13, 110, 137, 239,  99,  79,
+        114, 199, 172,  25, 190,  85, 169, 253, 128, 204, 103,  17, 119,  35,  97, 214,
+         49,  82, 142,  11, 102, 197,  23,  57, 148,  85,  47, 255,  64, 114, 235, 175,
+    },
+    {
+        251, 197,   1, 165,  54, 249, 145,  36, 104, 166,   6,  94, 210,  23, 190,  49,
+        242, 119, 198,  91, 126, 180, 241,  22, 122, 199, 163, 209,  57,  35, 176, 218,
+        149,  12,  77, 245, 126,  56, 106,  20, 182,  46, 221, 168,  76, 206, 150,   3,
+        186, 226, 113, 243, 152,  73, 250, 131, 194,   4, 212, 172,  21, 200, 138,  75,
+    },
+    {
+         52, 147,  97, 233, 134,  15, 193,  82, 235, 206,  48, 241, 123, 169,  84, 131,
+        208,  38, 147,  57, 218,  46, 106, 170,  60, 146,  28,  83, 231, 152,  17, 130,
+         46, 233,  96,  37, 213, 162, 228, 139,  68,  94,  28, 248, 141,  58, 233,  89,
+        134,  65,  32, 193,  49, 175,  96,  36, 230,  68, 124,  97, 151, 224,   8, 106,
+    },
+    {
+        212,  28, 177,  70,  40, 215,  99,  26, 155, 128,  74, 182,  31,  60, 228,  11,
+        161,  80, 250, 189,  12, 162,  87, 203, 254,  43, 222, 125, 181, 104, 250,  66,
+        207, 164, 186, 111, 146,  16,  44, 190, 242, 156, 121, 188,  13, 111, 176,  25,
+        241, 169, 208,  87, 127,   6, 218, 163, 106, 181, 239,  32,  80,  58, 186, 166,
+    },
+    {
+         85, 242, 114, 203, 160, 119, 182, 244,  60,  16, 223, 147, 110, 255, 138,  99,
+        186,  21, 107, 133,  72, 237, 143,   8,  75, 113, 189,   4,  71,  40, 194,  90,
+        118,   2,  58, 225,  71, 204,  83, 103,  11, 212,  59,  81, 216,  44, 200, 124,
+         51, 102,  14, 146, 234, 187,  58, 140,  17,  49, 157, 196, 131, 248,  37, 122,
+    },
+    {
+         19, 142,  56,   9, 254,  75,  48, 139, 173, 107, 190,  89,   5, 171,  40, 214,
+         65, 222, 167,  30, 208, 119,  39, 215, 173, 137,  92, 244, 148, 169, 224,  26,
+        156, 242, 139,  29, 170, 124, 233, 166, 133,  37, 180, 138, 236,  96, 153,  76,
+        219, 160, 247,  70,  28, 112,  80, 204, 225,  87, 113,  22, 211,  98, 155, 230,
+    },
+    {
+         77, 220, 181,  94, 149,  24, 229,  87, 209,  33, 235,  47, 218, 201,  80, 152,
+        125,  50, 239,  94, 153,  58, 185, 107,  20, 236,  54, 207,  20, 112, 133,  49,
+        183,  74, 200,  94, 253,   7,  53, 198,  73, 240, 100,   4, 164,  31, 249,   9,
+        137,  36, 181, 120, 201, 156, 253,  38, 126, 187, 245,  55, 172,   3,  67, 196,
+    },
+    {
+        168, 125,  36, 210, 109, 193, 129,   2, 154,  71, 126, 161,  61, 120,  22, 246,
+          9, 199,  75, 182,   1, 251,  84, 223,  66, 154,  32, 175,  86,  61, 247, 208,
+        103,  19, 127,  45, 182, 110, 152,  28, 117, 218,  51, 205, 123,  66, 189, 114,
+        204,  91,  61, 221,  47,  93,  15, 177,  69,   8, 141,  77, 234, 146, 116,  47,
+    },
+    {
+         14,  90, 240,  65, 163,  42, 219, 104, 242, 180,  15, 249, 143,  93, 193, 165,
+        106, 145,  37, 121, 214, 139,  28, 162, 127, 195, 102, 229, 142, 192,   6,  81,
+        149, 239, 215, 161,  69, 211,  90, 245, 168,  17, 149, 177,  84, 231,  46, 170,
+         22, 238, 141,   1, 169, 233, 146, 105, 230, 159, 216, 109,  41, 183, 210, 248,
+    },
+    {
+        158, 194, 143,   7, 233,  82, 174,  62,  37, 115,  81, 187,  27, 227,  44,  68,
+        237,  88, 225, 166,  55,  98, 202,  46, 246,   6,  71, 121,  41, 217, 108, 177,
+         34,  62, 113,  11, 231,  36, 127,  62, 193,  78, 108, 255,  24, 142,  99, 223,
+         79, 158, 109, 196,  78, 124,  59, 197,  43,  92,  27, 191, 131,  84,  29, 100,
+    },
+    {
+        227,  70,  32, 187, 117, 137,  17, 197, 141, 224, 206,  50, 108, 173, 137, 212,
+         31, 184,  11, 109, 243,  16, 179, 116,  91, 211, 148, 240,  18, 159,  54, 132,
+        228, 157, 191,  83, 140, 197, 162,   2, 216, 138,  35,  58, 212, 182,   6, 128,
+         56, 207,  42, 251,  20, 188,  30, 246, 132, 207,  60, 254,  10, 231, 140,  52,
+    },
+    {
+        108, 131, 252,  96,  53, 210, 245,  77, 165,   9,  96, 156, 240,  76,   3, 114,
+        157,  59, 136, 192,  73, 152, 236,  64, 166,  30, 180,  57, 188,  89, 250, 196,
+         10,  95,  44, 250,  25,  99, 236,  49,  94, 175, 228, 160, 117,  73, 200, 164,
+        244,  26, 136,  99, 153, 221,  87, 165,   5, 116, 174, 103, 161,  70, 179, 204,
+    },
+    {
+          2,  45, 208, 145, 172,  29, 105,  47, 120, 254,  64, 135,  21, 189, 225,  93,
+        200, 253,  84,  29, 206,  44, 128,  23, 228, 136,  82, 109, 220, 124,  24,  75,
+        117, 216, 178, 121, 154,  69, 183, 120, 246,  20, 129,  88,  15, 235,  39, 110,
+         90, 186,  72, 174,  52, 111, 143,  68, 185, 239,  79,  31, 218, 120,  25, 153,
+    },
+    {
+        222, 182,  83,  13,  71, 224, 156, 185, 214,  33, 173, 202,  42, 120, 150,  51,
+         18, 125, 171, 227, 141,  89, 220, 107, 197,  43, 255,   2, 154,  43, 175, 146,
+        241,  62,  18, 209,  50, 225,  12, 145,  72, 193,  54, 208, 172, 145,  62, 219,
+        151,  16, 232, 209,   6, 242,  41, 213,  21, 148,  45, 136, 188,  56, 248,  88,
+    },
+    {
+         62, 121, 155, 234, 191, 127,  90,   3, 145,  81, 111, 221,  90, 249,  68, 181,
+        235,  39,  67, 113,   3, 183, 160,  13,  67, 171, 121, 192,  72, 231, 205,  98,
+         38, 162, 136,  82, 173, 102, 202,  40, 165, 109, 240,  34, 102, 248, 130,  28,
+        195,  55, 122,  83, 160, 197, 130,  91, 229, 109, 197, 234,  12,  97, 209, 137,
+    },
+    {
+         18, 244,  36, 109,  56,  23, 241,  66, 228, 191,  15,  57, 158,   8, 211, 132,
+        105, 207, 151, 246,  55, 212,  75, 245, 148,  91, 211,  33, 104, 135,  60,   8,
+        189, 222, 105, 242,  29, 130, 252,  86, 219,   7, 136,  76, 185,   2,  87, 170,
+        105, 251, 144,  34, 104,  66, 177,  30, 164,  59,  84, 157, 116, 173,  38, 164,
+    },
+    {
+        101, 196,  75, 215, 171, 142, 202, 118,  47, 132, 169, 232, 125,  98,  36, 168,
+         15,  85, 178,  22,  98, 132,  41, 113,  27, 226,  57, 157, 242,  21, 169, 237,
+        126,  72,  12, 197,  60, 159,  18, 121, 178,  61, 199, 159, 225,  51, 203, 229,
+         74,   9, 211, 181, 227,  12, 255, 117, 206,   2, 248,  29,  64, 200,  80, 230,
+    },
+    {
+         52, 176, 135,   5, 253,  99,  35, 164,  93, 250,  34,  76, 198, 178, 243,  72,
+        222,  45, 135, 232, 192, 166, 223, 196, 176, 130,   9, 184,  75, 214, 115,  83,
+        152,  45, 179, 143, 233,  79, 192,  51, 147, 235,  95,  20, 125, 107, 150,  40,
+        132, 167,  93,  51, 124, 152,  46,  74, 142, 183, 122, 216, 140, 243,   6, 125,
+    },
+    {
+        211,  29,  88, 157,  49,  73, 182, 218,  21, 205, 108, 145,  19,  52, 142, 112,
+        158, 196, 106,  66,  33,  81,   6,  96,  47, 251,  85, 110, 146,  46, 193,  32,
+        209, 254, 117,  96,  39, 215, 106, 227,  27, 115,  44, 254,  67, 183,  14, 244,
+         63, 194,  26, 239,  78, 196, 216, 100, 230,  36,  93, 170,  48, 106, 182, 148,
+    },
+    {
+        249, 115, 234, 205, 123, 229,  10, 134,  83, 157,  63, 238, 208,  89, 226,   5,
+         58, 254,  12, 209, 122, 155, 234, 144,  71, 162, 205, 227,  16, 247, 160, 105,
+          2,  63, 200,  20, 174, 131,  11, 164,  72, 186, 209, 138, 168, 221,  86, 207,
+        118, 154, 220, 108, 171,  23, 133,  14, 166,  60, 207,  21,  82, 226,  35,  70,
+    },
+    {
+         12, 170,  64,  19, 190, 152, 102, 245,  46, 189,   2, 170, 121,  33, 193, 130,
+        180,  92, 141, 173, 244,  57, 112, 209,  17, 125,  35,  61, 136,  92,  67, 178,
+        222, 139, 163,  78, 243,  59, 205,  94, 246, 153,   4,  88,  27,  55, 144,  34,
+         99,   6,  60, 140,  40, 244,  68, 190, 249, 114, 149, 235, 129, 191, 156,  96,
+    },
+    {
+        202,  45, 142, 108,  80,  34,  61, 199, 116, 223, 137,  97,  56, 249, 154,  74,
+         39, 233,  26,  77,  41, 187,  23, 171, 240, 102, 188, 168, 201,  24, 236, 128,
+         52,  92, 230,  34, 111, 145, 184,  40, 127,  59, 110, 237, 201, 120, 241, 186,
+        165, 253, 202,  85, 188, 118,  92, 155,  47,  79,   7, 178,  63,  16, 213, 124,
+    },
+    {
+         78, 188, 225, 160, 241, 215, 170, 144,  22,  75,  37, 232, 181,  17, 101, 221,
+        116, 206, 157, 103, 225, 137,  93,  66,  43, 222,  76,   4, 119, 216, 151,  31,
+        205,  13, 121, 180, 214,   6,  82, 232,  21, 219, 176,  37, 163,  96,  10,  76,
+         51, 124,  27, 223, 152,   3, 210,  32, 219, 134, 201,  94, 251, 111,  53, 238,
+    },
+    {
+        135,   1,  91,  24,  53, 125,   5,  83, 235, 173, 205,  81, 146, 210,  63, 172,
+          9,  51, 190, 129,   1, 204, 252, 150, 198, 131, 154, 250,  97,  45,  77, 109,
+        186, 248, 148,  70,  46, 253, 167, 108, 143, 197,  78, 135,  64, 218, 130, 228,
+        194,  97, 172,  69,  48, 234, 127, 181, 106, 241,  29, 165,  41, 145, 175,  31,
+    },
+    {
+        164, 255, 119, 175, 205,  94, 247, 187, 111,  58, 155,   9, 119,  45, 134, 237,
+        149,  87, 247,  64, 171,  79,  30, 110,  11,  89,  29,  59, 192, 174, 242, 162,
+         58,  86,  25, 203, 103, 132,  65, 210,  49,  96,   8, 252, 186,  24, 158,  42,
+        145,  16, 237, 136, 108, 168,  78,  58,  11, 158,  66, 121, 217,  83, 226, 102,
+    },
+};
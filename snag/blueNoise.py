@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+# Generates blueNoise.c: a 64x64 tileable blue-noise threshold texture made
+# with the void-and-cluster method (Ulichney 1993), Gaussian sigma 1.5 on
+# a torus. Ranks 0..4095 are scaled to thresholds 1..255, so black stays
+# black and white stays white.
+#
+#     python3 blueNoise.py > blueNoise.c
+
+import math
+import random
+
+SIZE = 64
+SIGMA = 1.5
+N = SIZE * SIZE
+
+random.seed(1993)
+
+kernel = [0.0] * N
+for dy in range(SIZE):
+    for dx in range(SIZE):
+        wy = min(dy, SIZE - dy)
+        wx = min(dx, SIZE - dx)
+        kernel[dy * SIZE + dx] = math.exp(-(wx * wx + wy * wy) / (2 * SIGMA * SIGMA))
+
+
+def splat(energy, p, sign):
+    py, px = divmod(p, SIZE)
+    for y in range(SIZE):
+        row = ((y - py) % SIZE) * SIZE
+        base = y * SIZE
+        for x in range(SIZE):
+            energy[base + x] += sign * kernel[row + (x - px) % SIZE]
+
+
+def tightestCluster(pattern, energy):
+    return max((e, p) for p, e in enumerate(energy) if pattern[p])[1]
+
+
+def largestVoid(pattern, energy):
+    return min((e, p) for p, e in enumerate(energy) if not pattern[p])[1]
+
+
+# initial binary pattern, relaxed until removing the tightest cluster and
+# filling the largest void is the same point
+pattern = [False] * N
+energy = [0.0] * N
+ones = N // 10
+for p in random.sample(range(N), ones):
+    pattern[p] = True
+    splat(energy, p, 1)
+
+while True:
+    cluster = tightestCluster(pattern, energy)
+    pattern[cluster] = False
+    splat(energy, cluster, -1)
+    void = largestVoid(pattern, energy)
+    pattern[void] = True
+    splat(energy, void, 1)
+    if void == cluster:
+        break
+
+ranks = [0] * N
+
+# phase 1: rank the initial points by removing tightest clusters
+phase = list(pattern)
+phaseEnergy = list(energy)
+for rank in range(ones - 1, -1, -1):
+    cluster = tightestCluster(phase, phaseEnergy)
+    phase[cluster] = False
+    splat(phaseEnergy, cluster, -1)
+    ranks[cluster] = rank
+
+# phases 2 and 3: fill the largest voids until the texture is full
+for rank in range(ones, N):
+    void = largestVoid(pattern, energy)
+    pattern[void] = True
+    splat(energy, void, 1)
+    ranks[void] = rank
+
+print("// Generated by blueNoise.py, do not edit.")
+print()
+print("#include <stdint.h>")
+print()
+print('#include "dither.h"')
+print()
+print("//" + "-" * 73)
+print()
+print("const uint8_t BLUE_NOISE64X64[64][64] =")
+print("{")
+for y in range(SIZE):
+    values = [1 + ranks[y * SIZE + x] * 255 // N for x in range(SIZE)]
+    print("    {")
+    for i in range(0, SIZE, 16):
+        print("        " + ", ".join("%3d" % v for v in values[i:i + 16]) + ",")
+    print("    },")
+print("};")
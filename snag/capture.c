@@ -0,0 +1,248 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "capture.h"
+
+//-------------------------------------------------------------------------
+
+#define DEFAULT_FBDEV_DEVICE "/dev/fb0"
+#define DEFAULT_DRM_DEVICE "/dev/dri/card0"
+
+//-------------------------------------------------------------------------
+
+// Returns what follows "name" or "name:" in spec, "" for a bare name, or
+// NULL if spec is about another backend.
+
+static const char *
+matchBackend(
+    const char *spec,
+    const char *name)
+{
+    size_t length = strlen(name);
+
+    if (strncmp(spec, name, length) != 0)
+    {
+        return NULL;
+    }
+
+    if (spec[length] == '\0')
+    {
+        return "";
+    }
+
+    return (spec[length] == ':') ? spec + length + 1 : NULL;
+}
+
+//-------------------------------------------------------------------------
+
+static Capture *
+openBackend(
+    const char *spec,
+    uint32_t displayNumber,
+    const char **error)
+{
+    const char *argument;
+
+    if ((argument = matchBackend(spec, "dispmanx")) != NULL)
+    {
+#ifdef SNAG_HAVE_DISPMANX
+        if (*argument != '\0')
+        {
+            displayNumber = atoi(argument);
+        }
+
+        return openDispmanxCapture(displayNumber, error);
+#else
+        *error = "built without dispmanx capture";
+        errno = ENOTSUP;
+        return NULL;
+#endif
+    }
+
+    if ((argument = matchBackend(spec, "fbdev")) != NULL)
+    {
+        return openFbdevCapture((*argument != '\0') ? argument : DEFAULT_FBDEV_DEVICE,
+                                error);
+    }
+
+    if ((argument = matchBackend(spec, "drm")) != NULL)
+    {
+#ifdef SNAG_HAVE_DRM
+        return openDrmCapture((*argument != '\0') ? argument : DEFAULT_DRM_DEVICE,
+                              error);
+#else
+        *error = "built without DRM capture (libdrm not found)";
+        errno = ENOTSUP;
+        return NULL;
+#endif
+    }
+
+    if ((argument = matchBackend(spec, "x11")) != NULL)
+    {
+#ifdef SNAG_HAVE_X11
+        return openX11Capture((*argument != '\0') ? argument : NULL, error);
+#else
+        *error = "built without X11 capture (libxdamage not found)";
+        errno = ENOTSUP;
+        return NULL;
+#endif
+    }
+
+    if ((argument = matchBackend(spec, "file")) != NULL)
+    {
+        unsigned width = 0;
+        unsigned height = 0;
+        unsigned bits = 16;
+        int consumed = 0;
+
+        if (sscanf(argument, "%ux%ux%u:%n", &width, &height, &bits, &consumed) != 3)
+        {
+            bits = 16;
+            sscanf(argument, "%ux%u:%n", &width, &height, &consumed);
+        }
+
+        if ((consumed == 0) ||
+            (width == 0) ||
+            (height == 0) ||
+            ((bits != 8) && (bits != 16) && (bits != 32)))
+        {
+            *error = "file capture needs file:<width>x<height>[x<8|16|32>]:<path>";
+            errno = EINVAL;
+            return NULL;
+        }
+
+        PixelFormat format = (bits == 8) ? PIXEL_FORMAT_PALETTE8
+                           : (bits == 32) ? PIXEL_FORMAT_XRGB8888
+                           : PIXEL_FORMAT_RGB565;
+
+        return openFileCapture(argument + consumed, width, height, format, error);
+    }
+
+    *error = "unknown capture source";
+    errno = EINVAL;
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+Capture *
+openCapture(
+    const char *spec,
+    uint32_t displayNumber,
+    const char **error)
+{
+    Capture *capture = openBackend(spec, displayNumber, error);
+
+    if (capture != NULL)
+    {
+        CaptureRect whole = { 0, 0, capture->width, capture->height };
+
+        capture->region = whole;
+        capture->window = whole;
+        capture->changed = whole;
+    }
+
+    return capture;
+}
+
+//-------------------------------------------------------------------------
+
+void
+closeCapture(
+    Capture *capture)
+{
+    if (capture != NULL)
+    {
+        capture->close(capture);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+setCaptureRegion(
+    Capture *capture,
+    const CaptureRect *region)
+{
+    if ((region->width == 0) ||
+        (region->height == 0) ||
+        (region->x >= capture->width) ||
+        (region->y >= capture->height) ||
+        (region->width > capture->width - region->x) ||
+        (region->height > capture->height - region->y))
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    capture->region = *region;
+    capture->width = region->width;
+    capture->height = region->height;
+    capture->window = (CaptureRect){ 0, 0, region->width, region->height };
+    capture->changed = capture->window;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+copyOutsideWindow(
+    const Capture *capture,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint32_t pitch)
+{
+    if (prev == pixels)
+    {
+        return;
+    }
+
+    const CaptureRect *window = &capture->window;
+    uint32_t right = window->x + window->width;
+
+    for (uint32_t y = 0; y < capture->height; y++)
+    {
+        uint16_t *row = pixels + y * pitch;
+        const uint16_t *prevRow = prev + y * pitch;
+
+        if ((y < window->y) || (y >= window->y + window->height))
+        {
+            memcpy(row, prevRow, capture->width * sizeof(uint16_t));
+            continue;
+        }
+
+        memcpy(row, prevRow, window->x * sizeof(uint16_t));
+        memcpy(row + right, prevRow + right, (capture->width - right) * sizeof(uint16_t));
+    }
+}
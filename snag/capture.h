@@ -0,0 +1,189 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "pixelFormat.h"
+
+//-------------------------------------------------------------------------
+
+// Where frames come from. Every backend delivers RGB565 frames at the
+// source's own size, or the size of the region set with
+// setCaptureRegion(); scaling and conversion are shared (scale.h,
+// convert.h).
+//
+//     dispmanx[:<display>]          Raspberry Pi firmware display
+//     fbdev[:<device>]              a framebuffer (default /dev/fb0)
+//     drm[:<device>]                KMS scanout buffer (default /dev/dri/card0)
+//     x11[:<display>]               an X server's root window, through
+//                                   XDamage and MIT-SHM (default $DISPLAY)
+//     file:<width>x<height>[x<bits>]:<path>
+//                                   raw frames from a file or pipe, - for
+//                                   stdin: 16 (RGB565, the default), 32
+//                                   (XRGB8888) or 8 (gray) bits per pixel
+
+typedef struct
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} CaptureRect;
+
+typedef struct Capture Capture;
+
+struct Capture
+{
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+
+    // The part of the source captured, in source pixels; width and
+    // height are its size.
+    CaptureRect region;
+
+    // The part of the frame the next grab reads, in frame pixels; the
+    // rest is copied from prev. The whole frame unless the caller
+    // narrows it before a grab.
+    CaptureRect window;
+
+    // The part of the window the last grab may have changed, in frame
+    // pixels. The caller sets it to the window before each grab; backends
+    // that are told what changed narrow it.
+    CaptureRect changed;
+
+    // Copies the current frame into pixels (pitch in pixels). prev holds
+    // the previous frame and may be pixels itself; backends that know
+    // which rows changed copy the others from it. Returns false with
+    // errno set on failure, or errno 0 at the end of a file.
+    bool
+    (*grab)(
+        Capture *capture,
+        uint16_t *pixels,
+        const uint16_t *prev,
+        uint32_t pitch);
+
+    // Optional, NULL if the source has no vertical blank to wait for.
+    // Blocks until the next vertical blank or until deadline (absolute,
+    // CLOCK_MONOTONIC) and returns false if the deadline came first or
+    // the display does not report vertical blanks.
+    bool
+    (*waitVsync)(
+        Capture *capture,
+        const struct timespec *deadline);
+
+    void
+    (*close)(
+        Capture *capture);
+
+    void *state;
+};
+
+//-------------------------------------------------------------------------
+
+// Opens the backend named by spec. displayNumber is the dispmanx display
+// used when spec does not give one. Returns NULL with errno set and a
+// reason in *error on failure.
+
+Capture *
+openCapture(
+    const char *spec,
+    uint32_t displayNumber,
+    const char **error);
+
+void
+closeCapture(
+    Capture *capture);
+
+// Narrows the capture to a region of the source, before the first grab.
+// Returns false with errno EINVAL if the region is empty or not inside
+// the source.
+
+bool
+setCaptureRegion(
+    Capture *capture,
+    const CaptureRect *region);
+
+// For backends: copies the pixels outside the window from prev, unless
+// prev is pixels.
+
+void
+copyOutsideWindow(
+    const Capture *capture,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint32_t pitch);
+
+//-------------------------------------------------------------------------
+
+// The backends, for openCapture()
+
+#ifdef SNAG_HAVE_DISPMANX
+Capture *
+openDispmanxCapture(
+    uint32_t displayNumber,
+    const char **error);
+#endif
+
+Capture *
+openFbdevCapture(
+    const char *device,
+    const char **error);
+
+#ifdef SNAG_HAVE_DRM
+Capture *
+openDrmCapture(
+    const char *device,
+    const char **error);
+#endif
+
+#ifdef SNAG_HAVE_X11
+Capture *
+openX11Capture(
+    const char *display,
+    const char **error);
+#endif
+
+Capture *
+openFileCapture(
+    const char *path,
+    uint32_t width,
+    uint32_t height,
+    PixelFormat format,
+    const char **error);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,253 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#include "bcm_host.h"
+#pragma GCC diagnostic pop
+
+#include "capture.h"
+
+//-------------------------------------------------------------------------
+
+// Snapshots of the firmware's composited display (Buster, or Bullseye
+// with the legacy or fake KMS drivers).
+
+typedef struct
+{
+    DISPMANX_DISPLAY_HANDLE_T display;
+    DISPMANX_RESOURCE_HANDLE_T resource;
+    uint32_t width;             // of the display
+    uint16_t *rows;             // whole rows read, when cropping columns
+
+    // counted by the vsync callback, on a VideoCore thread
+    pthread_mutex_t vsyncLock;
+    pthread_cond_t vsyncSignal;
+    uint32_t vsyncs;
+} DispmanxState;
+
+//-------------------------------------------------------------------------
+
+static bool
+grabDispmanx(
+    Capture *capture,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint32_t pitch)
+{
+    DispmanxState *state = capture->state;
+    const CaptureRect *region = &capture->region;
+    const CaptureRect *window = &capture->window;
+
+    copyOutsideWindow(capture, pixels, prev, pitch);
+
+    if ((window->width == 0) || (window->height == 0))
+    {
+        return true;
+    }
+
+    // the firmware reads whole rows, from rect.y into the start of the
+    // buffer, so only a full width capture reads straight into pixels
+    bool fullWidth = (capture->width == state->width);
+    VC_RECT_T rect;
+    vc_dispmanx_rect_set(&rect, 0, region->y + window->y, state->width, window->height);
+
+    if ((vc_dispmanx_snapshot(state->display, state->resource, 0) != 0) ||
+        (vc_dispmanx_resource_read_data(state->resource,
+                                        &rect,
+                                        fullWidth ? pixels + window->y * pitch : state->rows,
+                                        (fullWidth ? pitch : state->width) * sizeof(uint16_t)) != 0))
+    {
+        errno = EIO;
+        return false;
+    }
+
+    if (!fullWidth)
+    {
+        for (uint32_t y = 0; y < window->height; y++)
+        {
+            memcpy(pixels + (window->y + y) * pitch + window->x,
+                   state->rows + y * state->width + region->x + window->x,
+                   window->width * sizeof(uint16_t));
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+vsyncCallback(
+    DISPMANX_UPDATE_HANDLE_T update,
+    void *arg)
+{
+    DispmanxState *state = arg;
+
+    pthread_mutex_lock(&state->vsyncLock);
+    ++state->vsyncs;
+    pthread_cond_broadcast(&state->vsyncSignal);
+    pthread_mutex_unlock(&state->vsyncLock);
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+waitVsyncDispmanx(
+    Capture *capture,
+    const struct timespec *deadline)
+{
+    DispmanxState *state = capture->state;
+    int result = 0;
+
+    pthread_mutex_lock(&state->vsyncLock);
+
+    uint32_t vsyncs = state->vsyncs;
+
+    while ((state->vsyncs == vsyncs) && (result == 0))
+    {
+        result = pthread_cond_timedwait(&state->vsyncSignal,
+                                        &state->vsyncLock,
+                                        deadline);
+    }
+
+    pthread_mutex_unlock(&state->vsyncLock);
+
+    return result == 0;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+closeDispmanx(
+    Capture *capture)
+{
+    DispmanxState *state = capture->state;
+
+    vc_dispmanx_vsync_callback(state->display, NULL, NULL);
+
+    if (state->resource != 0)
+    {
+        vc_dispmanx_resource_delete(state->resource);
+    }
+
+    vc_dispmanx_display_close(state->display);
+    free(state->rows);
+    pthread_cond_destroy(&state->vsyncSignal);
+    pthread_mutex_destroy(&state->vsyncLock);
+    free(state);
+    free(capture);
+}
+
+//-------------------------------------------------------------------------
+
+Capture *
+openDispmanxCapture(
+    uint32_t displayNumber,
+    const char **error)
+{
+    Capture *capture = calloc(1, sizeof(Capture));
+    DispmanxState *state = calloc(1, sizeof(DispmanxState));
+
+    if ((capture == NULL) || (state == NULL))
+    {
+        free(capture);
+        free(state);
+        *error = "cannot allocate dispmanx capture";
+        return NULL;
+    }
+
+    bcm_host_init();
+
+    state->display = vc_dispmanx_display_open(displayNumber);
+
+    if (state->display == 0)
+    {
+        free(capture);
+        free(state);
+        *error = "cannot open display";
+        errno = ENODEV;
+        return NULL;
+    }
+
+    capture->name = "dispmanx";
+    capture->grab = grabDispmanx;
+    capture->close = closeDispmanx;
+    capture->state = state;
+
+    // timed waits are against CLOCK_MONOTONIC, like the frame deadlines
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&state->vsyncSignal, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&state->vsyncLock, NULL);
+
+    DISPMANX_MODEINFO_T info;
+
+    if (vc_dispmanx_display_get_info(state->display, &info) != 0)
+    {
+        closeDispmanx(capture);
+        *error = "cannot get display dimensions";
+        errno = EIO;
+        return NULL;
+    }
+
+    capture->width = info.width;
+    capture->height = info.height;
+
+    state->width = info.width;
+    state->rows = malloc(info.width * info.height * sizeof(uint16_t));
+
+    if (state->rows == NULL)
+    {
+        closeDispmanx(capture);
+        *error = "cannot allocate dispmanx capture";
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    uint32_t image_ptr;
+
+    state->resource = vc_dispmanx_resource_create(VC_IMAGE_RGB565,
+                                                  capture->width,
+                                                  capture->height,
+                                                  &image_ptr);
+
+    if (vc_dispmanx_vsync_callback(state->display, vsyncCallback, state) == 0)
+    {
+        capture->waitVsync = waitVsyncDispmanx;
+    }
+
+    return capture;
+}
@@ -0,0 +1,828 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/dma-buf.h>
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <drm_fourcc.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include "capture.h"
+#include "pixelFormat.h"
+
+// Captures the scanout buffer of the first active primary plane of a DRM
+// device (vc4 with KMS, vkms, ...). The framebuffer is looked up with
+// drmModeGetFB2 and mapped directly, as a dumb buffer or else through a
+// PRIME dma-buf. The last DRM_CACHED_FRAMEBUFFERS framebuffers stay
+// mapped, so a compositor flipping between its buffers is not mapped again
+// on every flip. XRGB8888, ARGB8888, XBGR8888, ABGR8888 and RGB565 buffers
+// are read in their own format, and C8 through the CRTC's gamma table,
+// which is its palette.
+//
+// When the plane's FB_DAMAGE_CLIPS property is set (frontbuffer clients
+// using DIRTYFB, compositors that pass damage) only the damaged rows of
+// the capture window are read; the rest are copied from the previous
+// frame. The property only holds the clips of the last commit, and
+// frontbuffer clients commit several times a frame, so the damage of
+// earlier commits since the last capture is lost. Nothing in the atomic
+// state tells how many commits there were (blob ids are reused), so
+// every DRM_FULL_CAPTURE_FRAMES frames every row is read again, which
+// bounds how long a missed update stays on the panel.
+//
+// drmModeGetFB2 only returns buffer handles to root (CAP_SYS_ADMIN).
+
+#define DRM_FULL_CAPTURE_FRAMES 4
+
+// Framebuffers kept mapped, enough for a compositor's double or triple
+// buffering to flip between them without mapping anything again. A flip
+// still asks the kernel whether the id names the buffer mapped, since a
+// removed framebuffer's id is reused, but the mapping and its page
+// faults are not redone.
+#define DRM_CACHED_FRAMEBUFFERS 3
+
+//-------------------------------------------------------------------------
+
+// A mapped framebuffer
+
+typedef struct
+{
+    uint32_t fbId;              // 0 if the entry is free
+    uint64_t identity;          // of the buffer, see findBuffer()
+    PixelFormat format;
+    uint32_t pixelBytes;
+    PixelReader read;
+    uint32_t width;             // the mode, clipped to the framebuffer
+    uint32_t height;
+    uint32_t pitch;             // bytes
+    uint8_t *map;
+    size_t mapSize;
+    uint32_t offset;
+    int dmabuf;                 // -1 when mapped as a dumb buffer
+    uint64_t used;              // grab it was last read in
+} DrmMapping;
+
+typedef struct
+{
+    int fd;
+    uint32_t planeId;
+    uint32_t damagePropertyId;  // 0 if the plane has no FB_DAMAGE_CLIPS
+    uint32_t width;
+    uint32_t height;
+    uint32_t vblankType;        // relative, on the CRTC scanning out the plane
+    uint32_t crtcId;
+    uint32_t gammaSize;
+
+    DrmMapping mappings[DRM_CACHED_FRAMEBUFFERS];
+    DrmMapping *current;        // of the framebuffer scanned out
+    uint64_t grabs;
+    uint16_t palette[256];      // RGB565 of each index of a C8 buffer
+
+    uint32_t framesToFull;
+    uint8_t *damagedRows;
+} DrmState;
+
+//-------------------------------------------------------------------------
+
+// Returns the id of the property called name on an object, and its value.
+
+static uint32_t
+findProperty(
+    int fd,
+    uint32_t objectId,
+    uint32_t objectType,
+    const char *name,
+    uint64_t *value)
+{
+    drmModeObjectPropertiesPtr properties =
+        drmModeObjectGetProperties(fd, objectId, objectType);
+    uint32_t id = 0;
+
+    if (properties == NULL)
+    {
+        return 0;
+    }
+
+    for (uint32_t i = 0; (i < properties->count_props) && (id == 0); i++)
+    {
+        drmModePropertyPtr property = drmModeGetProperty(fd, properties->props[i]);
+
+        if (property == NULL)
+        {
+            continue;
+        }
+
+        if (strcmp(property->name, name) == 0)
+        {
+            id = property->prop_id;
+
+            if (value != NULL)
+            {
+                *value = properties->prop_values[i];
+            }
+        }
+
+        drmModeFreeProperty(property);
+    }
+
+    drmModeFreeObjectProperties(properties);
+
+    return id;
+}
+
+//-------------------------------------------------------------------------
+
+// Returns the value of the property with id propertyId on an object, or
+// 0 if the object has no such property. Cheaper than findProperty(), which
+// looks up every property to compare names.
+
+static uint64_t
+propertyValue(
+    int fd,
+    uint32_t objectId,
+    uint32_t objectType,
+    uint32_t propertyId)
+{
+    drmModeObjectPropertiesPtr properties =
+        drmModeObjectGetProperties(fd, objectId, objectType);
+    uint64_t value = 0;
+
+    if (properties == NULL)
+    {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < properties->count_props; i++)
+    {
+        if (properties->props[i] == propertyId)
+        {
+            value = properties->prop_values[i];
+            break;
+        }
+    }
+
+    drmModeFreeObjectProperties(properties);
+
+    return value;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+unmapFramebuffer(
+    DrmMapping *mapping)
+{
+    if (mapping->map != NULL)
+    {
+        munmap(mapping->map, mapping->mapSize);
+    }
+
+    if (mapping->dmabuf != -1)
+    {
+        close(mapping->dmabuf);
+    }
+
+    *mapping = (DrmMapping){ .dmabuf = -1 };
+}
+
+//-------------------------------------------------------------------------
+
+// Returns false for a DRM format there is no reader for.
+
+static bool
+findFormat(
+    uint32_t fourcc,
+    PixelFormat *format)
+{
+    switch (fourcc)
+    {
+    case DRM_FORMAT_RGB565:
+        *format = PIXEL_FORMAT_RGB565;
+        return true;
+    case DRM_FORMAT_XRGB8888:
+    case DRM_FORMAT_ARGB8888:
+        *format = PIXEL_FORMAT_XRGB8888;
+        return true;
+    case DRM_FORMAT_XBGR8888:
+    case DRM_FORMAT_ABGR8888:
+        *format = PIXEL_FORMAT_XBGR8888;
+        return true;
+    case DRM_FORMAT_C8:
+        *format = PIXEL_FORMAT_PALETTE8;
+        return true;
+    default:
+        return false;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// A C8 buffer's palette is the CRTC's 256 entry gamma table, re-read for
+// every grab so a change of palette shows like any other change. Gray
+// levels if the table cannot be read.
+
+static void
+readPalette(
+    DrmState *state)
+{
+    uint16_t red[256];
+    uint16_t green[256];
+    uint16_t blue[256];
+
+    if ((state->gammaSize == 256) &&
+        (drmModeCrtcGetGamma(state->fd, state->crtcId, 256, red, green, blue) == 0))
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            state->palette[i] = rgb565(red[i] >> 8, green[i] >> 8, blue[i] >> 8);
+        }
+
+        return;
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        state->palette[i] = rgb565(i, i, i);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Finds how to map the buffer behind a handle: a dumb buffer through the
+// DRM fd at *offset, anything else through a PRIME dma-buf, whose fd is
+// returned in *dmabuf. *identity tells buffers apart: the map offset of a
+// dumb buffer, the inode of a dma-buf, both fixed for the buffer's life.
+
+static bool
+findBuffer(
+    int fd,
+    uint32_t handle,
+    uint64_t *offset,
+    int *dmabuf,
+    uint64_t *identity)
+{
+    struct drm_mode_map_dumb mapDumb = { .handle = handle };
+
+    if (drmIoctl(fd, DRM_IOCTL_MODE_MAP_DUMB, &mapDumb) == 0)
+    {
+        *offset = mapDumb.offset;
+        *identity = mapDumb.offset;
+        return true;
+    }
+
+    if (drmPrimeHandleToFD(fd, handle, DRM_CLOEXEC, dmabuf) != 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(*dmabuf, &st) == -1)
+    {
+        close(*dmabuf);
+        *dmabuf = -1;
+        return false;
+    }
+
+    *offset = 0;
+    *identity = st.st_ino;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+// Returns the mapping of framebuffer fbId: the cached one if it is still
+// of the same buffer with the same layout, otherwise a new one in place
+// of the least recently used. NULL with errno set on failure.
+
+static DrmMapping *
+mapFramebuffer(
+    DrmState *state,
+    uint32_t fbId)
+{
+    drmModeFB2Ptr fb = drmModeGetFB2(state->fd, fbId);
+
+    if (fb == NULL)
+    {
+        return NULL;
+    }
+
+    DrmMapping *mapping = NULL;
+    DrmMapping *oldest = &state->mappings[0];
+
+    for (int i = 0; i < DRM_CACHED_FRAMEBUFFERS; i++)
+    {
+        if (state->mappings[i].fbId == fbId)
+        {
+            mapping = &state->mappings[i];
+        }
+
+        if (state->mappings[i].used < oldest->used)
+        {
+            oldest = &state->mappings[i];
+        }
+    }
+
+    PixelFormat format = PIXEL_FORMAT_RGB565;
+    uint64_t offset = 0;
+    uint64_t identity = 0;
+    int dmabuf = -1;
+    bool found = false;
+    uint32_t handle = fb->handles[0];
+
+    if (handle == 0)
+    {
+        errno = EACCES;
+    }
+    else if ((fb->modifier != DRM_FORMAT_MOD_LINEAR) &&
+             (fb->modifier != DRM_FORMAT_MOD_INVALID))
+    {
+        errno = ENOTSUP;
+    }
+    else if (!findFormat(fb->pixel_format, &format))
+    {
+        errno = ENOTSUP;
+    }
+    else
+    {
+        found = findBuffer(state->fd, handle, &offset, &dmabuf, &identity);
+    }
+
+    // a mapping or dma-buf keeps the buffer alive, the handles are not needed
+    for (int i = 0; i < 4; i++)
+    {
+        if ((fb->handles[i] != 0) &&
+            ((i == 0) || (fb->handles[i] != fb->handles[0])))
+        {
+            struct drm_gem_close gemClose = { .handle = fb->handles[i] };
+            drmIoctl(state->fd, DRM_IOCTL_GEM_CLOSE, &gemClose);
+        }
+    }
+
+    uint32_t width = (state->width < fb->width) ? state->width : fb->width;
+    uint32_t height = (state->height < fb->height) ? state->height : fb->height;
+
+    if (found &&
+        (mapping != NULL) &&
+        (mapping->identity == identity) &&
+        ((mapping->dmabuf == -1) == (dmabuf == -1)) &&
+        (mapping->format == format) &&
+        (mapping->pitch == fb->pitches[0]) &&
+        (mapping->offset == fb->offsets[0]) &&
+        (mapping->width == width) &&
+        (mapping->height == height))
+    {
+        // flipped back to a buffer still mapped
+        if (dmabuf != -1)
+        {
+            close(dmabuf);
+        }
+
+        drmModeFreeFB2(fb);
+        return mapping;
+    }
+
+    // the id was removed and reused, or is new
+    mapping = (mapping != NULL) ? mapping : oldest;
+    unmapFramebuffer(mapping);
+
+    if (found)
+    {
+        mapping->format = format;
+        mapping->pixelBytes = pixelFormatBytes(format);
+        mapping->read = selectPixelReader(format);
+        mapping->width = width;
+        mapping->height = height;
+        mapping->pitch = fb->pitches[0];
+        mapping->offset = fb->offsets[0];
+        mapping->mapSize = (size_t)fb->offsets[0] + (size_t)fb->pitches[0] * fb->height;
+        mapping->dmabuf = dmabuf;
+        mapping->map = mmap(NULL,
+                            mapping->mapSize,
+                            PROT_READ,
+                            MAP_SHARED,
+                            (dmabuf != -1) ? dmabuf : state->fd,
+                            offset);
+
+        if (mapping->map == MAP_FAILED)
+        {
+            mapping->map = NULL;
+        }
+    }
+
+    drmModeFreeFB2(fb);
+
+    if (!found || (mapping->map == NULL))
+    {
+        unmapFramebuffer(mapping);
+        return NULL;
+    }
+
+    mapping->fbId = fbId;
+    mapping->identity = identity;
+
+    return mapping;
+}
+
+//-------------------------------------------------------------------------
+
+// Flags the rows covered by the plane's damage clips. Returns false if
+// there are none, meaning the whole frame may have changed.
+
+static bool
+readDamage(
+    DrmState *state)
+{
+    if (state->damagePropertyId == 0)
+    {
+        return false;
+    }
+
+    uint64_t blobId = propertyValue(state->fd,
+                                    state->planeId,
+                                    DRM_MODE_OBJECT_PLANE,
+                                    state->damagePropertyId);
+
+    if (blobId == 0)
+    {
+        return false;
+    }
+
+    drmModePropertyBlobPtr blob = drmModeGetPropertyBlob(state->fd, blobId);
+
+    if (blob == NULL)
+    {
+        return false;
+    }
+
+    const struct drm_mode_rect *clips = blob->data;
+    uint32_t count = blob->length / sizeof(struct drm_mode_rect);
+
+    memset(state->damagedRows, 0, state->height);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int32_t y1 = (clips[i].y1 < 0) ? 0 : clips[i].y1;
+        int32_t y2 = (clips[i].y2 > (int32_t)state->height)
+                   ? (int32_t)state->height
+                   : clips[i].y2;
+
+        for (int32_t y = y1; y < y2; y++)
+        {
+            state->damagedRows[y] = 1;
+        }
+    }
+
+    drmModeFreePropertyBlob(blob);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+syncDmabuf(
+    const DrmMapping *mapping,
+    uint64_t flags)
+{
+    if (mapping->dmabuf != -1)
+    {
+        struct dma_buf_sync sync = { .flags = flags | DMA_BUF_SYNC_READ };
+        ioctl(mapping->dmabuf, DMA_BUF_IOCTL_SYNC, &sync);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+grabDrm(
+    Capture *capture,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint32_t pitch)
+{
+    DrmState *state = capture->state;
+    drmModePlanePtr plane = drmModeGetPlane(state->fd, state->planeId);
+
+    if (plane == NULL)
+    {
+        return false;
+    }
+
+    uint32_t fbId = plane->fb_id;
+    drmModeFreePlane(plane);
+
+    // a flip to another buffer makes the damage of this one meaningless
+    bool flipped = (state->current == NULL) || (fbId != state->current->fbId);
+    bool full = (state->framesToFull == 0) || flipped;
+
+    if (flipped)
+    {
+        state->current = mapFramebuffer(state, fbId);
+
+        if (state->current == NULL)
+        {
+            return false;
+        }
+    }
+
+    DrmMapping *mapping = state->current;
+    mapping->used = ++state->grabs;
+
+    if (!full && !readDamage(state))
+    {
+        full = true;
+    }
+
+    state->framesToFull = full ? DRM_FULL_CAPTURE_FRAMES : state->framesToFull - 1;
+
+    const CaptureRect *region = &capture->region;
+    const CaptureRect *window = &capture->window;
+    const uint8_t *src = mapping->map + mapping->offset;
+    uint32_t x0 = region->x + window->x;
+
+    // a framebuffer smaller than the mode leaves the rest of the window
+    uint32_t count = (x0 >= mapping->width) ? 0
+                   : (window->width < mapping->width - x0) ? window->width
+                   : mapping->width - x0;
+
+    if (mapping->format == PIXEL_FORMAT_PALETTE8)
+    {
+        readPalette(state);
+    }
+
+    copyOutsideWindow(capture, pixels, prev, pitch);
+    syncDmabuf(mapping, DMA_BUF_SYNC_START);
+
+    for (uint32_t y = window->y; y < window->y + window->height; y++)
+    {
+        uint32_t srcY = region->y + y;
+        uint16_t *row = pixels + y * pitch + window->x;
+
+        if ((srcY < mapping->height) && (full || state->damagedRows[srcY]))
+        {
+            mapping->read(src + srcY * mapping->pitch + x0 * mapping->pixelBytes,
+                        row,
+                        count,
+                        state->palette);
+        }
+        else if (prev != pixels)
+        {
+            memcpy(row, prev + y * pitch + window->x, window->width * sizeof(uint16_t));
+        }
+    }
+
+    syncDmabuf(mapping, DMA_BUF_SYNC_END);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+// Asks for an event on the next vertical blank and polls for it, so the
+// wait can end at the deadline. An event that comes after a timeout is
+// read by the next wait, which then returns early once.
+
+static bool
+waitVsyncDrm(
+    Capture *capture,
+    const struct timespec *deadline)
+{
+    DrmState *state = capture->state;
+    drmVBlank vblank =
+    {
+        .request =
+        {
+            .type = state->vblankType | DRM_VBLANK_EVENT,
+            .sequence = 1
+        }
+    };
+
+    if (drmWaitVBlank(state->fd, &vblank) != 0)
+    {
+        return false;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    struct timespec timeout = { 0, 0 };
+
+    if ((now.tv_sec < deadline->tv_sec) ||
+        ((now.tv_sec == deadline->tv_sec) && (now.tv_nsec < deadline->tv_nsec)))
+    {
+        timeout.tv_sec = deadline->tv_sec - now.tv_sec;
+        timeout.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+
+        if (timeout.tv_nsec < 0)
+        {
+            timeout.tv_nsec += 1000000000;
+            --timeout.tv_sec;
+        }
+    }
+
+    struct pollfd pfd = { .fd = state->fd, .events = POLLIN };
+
+    if (ppoll(&pfd, 1, &timeout, NULL) != 1)
+    {
+        return false;
+    }
+
+    drmEventContext context = { .version = DRM_EVENT_CONTEXT_VERSION };
+
+    return drmHandleEvent(state->fd, &context) == 0;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+closeDrm(
+    Capture *capture)
+{
+    DrmState *state = capture->state;
+    int error = errno;  // for the error paths of openDrmCapture()
+
+    for (int i = 0; i < DRM_CACHED_FRAMEBUFFERS; i++)
+    {
+        unmapFramebuffer(&state->mappings[i]);
+    }
+
+    close(state->fd);
+    free(state->damagedRows);
+    free(state);
+    free(capture);
+    errno = error;
+}
+
+//-------------------------------------------------------------------------
+
+Capture *
+openDrmCapture(
+    const char *device,
+    const char **error)
+{
+    Capture *capture = calloc(1, sizeof(Capture));
+    DrmState *state = calloc(1, sizeof(DrmState));
+
+    if ((capture == NULL) || (state == NULL))
+    {
+        free(capture);
+        free(state);
+        *error = "cannot allocate DRM capture";
+        return NULL;
+    }
+
+    for (int i = 0; i < DRM_CACHED_FRAMEBUFFERS; i++)
+    {
+        state->mappings[i].dmabuf = -1;
+    }
+
+    state->fd = open(device, O_RDWR | O_CLOEXEC);
+
+    if (state->fd == -1)
+    {
+        free(capture);
+        free(state);
+        *error = "cannot open DRM device";
+        return NULL;
+    }
+
+    capture->name = "drm";
+    capture->grab = grabDrm;
+    capture->waitVsync = waitVsyncDrm;
+    capture->close = closeDrm;
+    capture->state = state;
+
+    // universal planes to see the primary plane, atomic for FB_DAMAGE_CLIPS
+    drmSetClientCap(state->fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
+    drmSetClientCap(state->fd, DRM_CLIENT_CAP_ATOMIC, 1);
+
+    drmModePlaneResPtr planes = drmModeGetPlaneResources(state->fd);
+    uint32_t crtcId = 0;
+
+    for (uint32_t i = 0; (planes != NULL) && (i < planes->count_planes); i++)
+    {
+        drmModePlanePtr plane = drmModeGetPlane(state->fd, planes->planes[i]);
+        uint64_t type = 0;
+
+        if (plane == NULL)
+        {
+            continue;
+        }
+
+        findProperty(state->fd, plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", &type);
+
+        if ((type == DRM_PLANE_TYPE_PRIMARY) &&
+            (plane->fb_id != 0) &&
+            (plane->crtc_id != 0) &&
+            (crtcId == 0))
+        {
+            state->planeId = plane->plane_id;
+            crtcId = plane->crtc_id;
+        }
+
+        drmModeFreePlane(plane);
+    }
+
+    drmModeFreePlaneResources(planes);
+
+    drmModeCrtcPtr crtc = (crtcId != 0) ? drmModeGetCrtc(state->fd, crtcId) : NULL;
+
+    if ((crtc == NULL) || !crtc->mode_valid)
+    {
+        drmModeFreeCrtc(crtc);
+        errno = ENODEV;
+        closeDrm(capture);
+        *error = "no active display on DRM device";
+        return NULL;
+    }
+
+    state->width = crtc->mode.hdisplay;
+    state->height = crtc->mode.vdisplay;
+    state->crtcId = crtcId;
+    state->gammaSize = crtc->gamma_size;
+    drmModeFreeCrtc(crtc);
+
+    // vblank requests name the CRTC by its index, not its id
+    drmModeResPtr resources = drmModeGetResources(state->fd);
+
+    for (int i = 0; (resources != NULL) && (i < resources->count_crtcs); i++)
+    {
+        if (resources->crtcs[i] != crtcId)
+        {
+            continue;
+        }
+
+        if (i == 1)
+        {
+            state->vblankType = DRM_VBLANK_SECONDARY;
+        }
+        else if (i > 1)
+        {
+            state->vblankType = (i << DRM_VBLANK_HIGH_CRTC_SHIFT) &
+                                DRM_VBLANK_HIGH_CRTC_MASK;
+        }
+    }
+
+    drmModeFreeResources(resources);
+    state->vblankType |= DRM_VBLANK_RELATIVE;
+
+    state->damagePropertyId = findProperty(state->fd,
+                                           state->planeId,
+                                           DRM_MODE_OBJECT_PLANE,
+                                           "FB_DAMAGE_CLIPS",
+                                           NULL);
+    state->damagedRows = calloc(state->height, 1);
+
+    if (state->damagedRows == NULL)
+    {
+        closeDrm(capture);
+        *error = "cannot allocate DRM capture";
+        return NULL;
+    }
+
+    capture->width = state->width;
+    capture->height = state->height;
+
+    return capture;
+}
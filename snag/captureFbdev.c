@@ -0,0 +1,334 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include "capture.h"
+#include "pixelFormat.h"
+
+//-------------------------------------------------------------------------
+
+// Reads a framebuffer device directly, e.g. /dev/fb0 on Bullseye where
+// dispmanx is gone. RGB565, XRGB8888/XBGR8888 and 8-bit palette
+// framebuffers are read in their own depth; one in any other format is
+// switched to 16 bits per pixel, if the driver allows it.
+
+typedef struct
+{
+    int fd;
+    uint8_t *map;
+    size_t mapSize;
+    uint32_t lineLength;
+    PixelFormat format;
+    uint32_t pixelBytes;
+    PixelReader read;
+    bool grayscale;             // 8 bits of gray rather than a palette
+    uint16_t palette[256];      // RGB565 of each index
+    bool noVsync;               // the driver has no FBIO_WAITFORVSYNC
+} FbdevState;
+
+//-------------------------------------------------------------------------
+
+// Returns false for a framebuffer format there is no reader for.
+
+static bool
+findFormat(
+    const struct fb_var_screeninfo *vinfo,
+    const struct fb_fix_screeninfo *finfo,
+    PixelFormat *format)
+{
+    switch (vinfo->bits_per_pixel)
+    {
+    case 8:
+        *format = PIXEL_FORMAT_PALETTE8;
+        return (vinfo->grayscale == 1) ||
+               (finfo->visual == FB_VISUAL_PSEUDOCOLOR) ||
+               (finfo->visual == FB_VISUAL_STATIC_PSEUDOCOLOR);
+
+    case 16:
+        *format = PIXEL_FORMAT_RGB565;
+        return (vinfo->red.offset == 11) && (vinfo->red.length == 5) &&
+               (vinfo->green.offset == 5) && (vinfo->green.length == 6) &&
+               (vinfo->blue.offset == 0) && (vinfo->blue.length == 5);
+
+    case 32:
+        if ((vinfo->green.offset != 8) || (vinfo->green.length != 8))
+        {
+            return false;
+        }
+
+        if ((vinfo->red.offset == 16) && (vinfo->blue.offset == 0))
+        {
+            *format = PIXEL_FORMAT_XRGB8888;
+            return true;
+        }
+
+        *format = PIXEL_FORMAT_XBGR8888;
+        return (vinfo->red.offset == 0) && (vinfo->blue.offset == 16);
+
+    default:
+        return false;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// The palette of an 8-bit framebuffer, read before every grab so a
+// change of palette shows like any other change. A gray framebuffer, or
+// a driver that will not give its palette, is read as gray levels.
+
+static void
+readPalette(
+    FbdevState *state)
+{
+    uint16_t red[256];
+    uint16_t green[256];
+    uint16_t blue[256];
+    struct fb_cmap cmap =
+    {
+        .start = 0,
+        .len = 256,
+        .red = red,
+        .green = green,
+        .blue = blue,
+        .transp = NULL
+    };
+
+    if (!state->grayscale && (ioctl(state->fd, FBIOGETCMAP, &cmap) == 0))
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            state->palette[i] = rgb565(red[i] >> 8, green[i] >> 8, blue[i] >> 8);
+        }
+
+        return;
+    }
+
+    state->grayscale = true;
+
+    for (int i = 0; i < 256; i++)
+    {
+        state->palette[i] = rgb565(i, i, i);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+grabFbdev(
+    Capture *capture,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint32_t pitch)
+{
+    FbdevState *state = capture->state;
+    struct fb_var_screeninfo vinfo;
+
+    // follow panning, double buffered clients flip with yoffset
+    if (ioctl(state->fd, FBIOGET_VSCREENINFO, &vinfo) == -1)
+    {
+        return false;
+    }
+
+    const CaptureRect *region = &capture->region;
+    const CaptureRect *window = &capture->window;
+
+    size_t offset = (size_t)vinfo.yoffset * state->lineLength +
+                    (size_t)vinfo.xoffset * state->pixelBytes;
+
+    if (offset + (size_t)(region->y + region->height - 1) * state->lineLength +
+        (region->x + region->width) * state->pixelBytes > state->mapSize)
+    {
+        offset = 0;
+    }
+
+    const uint8_t *src = state->map + offset +
+                         (size_t)(region->y + window->y) * state->lineLength +
+                         (size_t)(region->x + window->x) * state->pixelBytes;
+
+    if (state->format == PIXEL_FORMAT_PALETTE8)
+    {
+        readPalette(state);
+    }
+
+    copyOutsideWindow(capture, pixels, prev, pitch);
+
+    for (uint32_t y = 0; y < window->height; y++)
+    {
+        state->read(src + y * state->lineLength,
+                    pixels + (window->y + y) * pitch + window->x,
+                    window->width,
+                    state->palette);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+// FBIO_WAITFORVSYNC has no timeout, but blocks for at most one refresh.
+
+static bool
+waitVsyncFbdev(
+    Capture *capture,
+    const struct timespec *deadline)
+{
+    FbdevState *state = capture->state;
+    uint32_t crtc = 0;
+
+    if (!state->noVsync &&
+        (ioctl(state->fd, FBIO_WAITFORVSYNC, &crtc) == -1))
+    {
+        state->noVsync = true;
+    }
+
+    return !state->noVsync;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+closeFbdev(
+    Capture *capture)
+{
+    FbdevState *state = capture->state;
+    int error = errno;  // for the error paths of openFbdevCapture()
+
+    if (state->map != NULL)
+    {
+        munmap(state->map, state->mapSize);
+    }
+
+    close(state->fd);
+    free(state);
+    free(capture);
+    errno = error;
+}
+
+//-------------------------------------------------------------------------
+
+Capture *
+openFbdevCapture(
+    const char *device,
+    const char **error)
+{
+    Capture *capture = calloc(1, sizeof(Capture));
+    FbdevState *state = calloc(1, sizeof(FbdevState));
+
+    if ((capture == NULL) || (state == NULL))
+    {
+        free(capture);
+        free(state);
+        *error = "cannot allocate framebuffer capture";
+        return NULL;
+    }
+
+    capture->name = "fbdev";
+    capture->grab = grabFbdev;
+    capture->waitVsync = waitVsyncFbdev;
+    capture->close = closeFbdev;
+    capture->state = state;
+
+    state->fd = open(device, O_RDWR);
+
+    if (state->fd == -1)
+    {
+        free(capture);
+        free(state);
+        *error = "cannot open capture framebuffer";
+        return NULL;
+    }
+
+    struct fb_var_screeninfo vinfo;
+
+    if (ioctl(state->fd, FBIOGET_VSCREENINFO, &vinfo) == -1)
+    {
+        closeFbdev(capture);
+        *error = "cannot get capture framebuffer variable information";
+        return NULL;
+    }
+
+    struct fb_fix_screeninfo finfo;
+
+    if (ioctl(state->fd, FBIOGET_FSCREENINFO, &finfo) == -1)
+    {
+        closeFbdev(capture);
+        *error = "cannot get capture framebuffer fixed information";
+        return NULL;
+    }
+
+    if (!findFormat(&vinfo, &finfo, &state->format))
+    {
+        vinfo.bits_per_pixel = 16;
+
+        if ((ioctl(state->fd, FBIOPUT_VSCREENINFO, &vinfo) == -1) ||
+            (ioctl(state->fd, FBIOGET_FSCREENINFO, &finfo) == -1))
+        {
+            closeFbdev(capture);
+            *error = "cannot set capture framebuffer to 16 bits per pixel";
+            return NULL;
+        }
+
+        if (!findFormat(&vinfo, &finfo, &state->format))
+        {
+            errno = ENOTSUP;
+            closeFbdev(capture);
+            *error = "capture framebuffer pixel format not supported";
+            return NULL;
+        }
+    }
+
+    state->pixelBytes = pixelFormatBytes(state->format);
+    state->read = selectPixelReader(state->format);
+    state->grayscale = (vinfo.grayscale == 1);
+
+    capture->width = vinfo.xres;
+    capture->height = vinfo.yres;
+    state->lineLength = finfo.line_length;
+    state->mapSize = finfo.smem_len;
+    state->map = mmap(NULL, state->mapSize, PROT_READ, MAP_SHARED, state->fd, 0);
+
+    if (state->map == MAP_FAILED)
+    {
+        state->map = NULL;
+        closeFbdev(capture);
+        *error = "cannot map capture framebuffer into memory";
+        return NULL;
+    }
+
+    return capture;
+}
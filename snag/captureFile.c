@@ -0,0 +1,221 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "capture.h"
+#include "pixelFormat.h"
+
+//-------------------------------------------------------------------------
+
+// Raw frames with no padding between rows, read one after another from a
+// file or a pipe: RGB565 (little endian), XRGB8888 (B, G, R, X bytes) or
+// 8-bit gray. Recording a display and replaying it through snag makes
+// runs repeatable.
+
+typedef struct
+{
+    int fd;
+    uint32_t width;             // of the frames in the file
+    uint32_t height;
+    PixelFormat format;
+    PixelReader read;
+    uint16_t palette[256];      // gray levels for 8-bit frames
+    uint8_t *row;               // one file row, when not read in place
+} FileState;
+
+//-------------------------------------------------------------------------
+
+static bool
+readFully(
+    int fd,
+    void *buffer,
+    size_t length)
+{
+    uint8_t *bytes = buffer;
+
+    while (length > 0)
+    {
+        ssize_t got = read(fd, bytes, length);
+
+        if (got == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (got == 0)
+        {
+            errno = 0;
+            return false;
+        }
+
+        bytes += got;
+        length -= got;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+grabFile(
+    Capture *capture,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint32_t pitch)
+{
+    FileState *state = capture->state;
+    const CaptureRect *region = &capture->region;
+    const CaptureRect *window = &capture->window;
+    size_t rowSize = state->width * pixelFormatBytes(state->format);
+
+    if ((state->format == PIXEL_FORMAT_RGB565) &&
+        (window->width == state->width) &&
+        (window->height == state->height))
+    {
+        for (uint32_t y = 0; y < state->height; y++)
+        {
+            if (!readFully(state->fd, pixels + y * pitch, rowSize))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // every row is read to get to the next frame, only the window kept
+    uint32_t left = (region->x + window->x) * pixelFormatBytes(state->format);
+
+    copyOutsideWindow(capture, pixels, prev, pitch);
+
+    for (uint32_t y = 0; y < state->height; y++)
+    {
+        if (!readFully(state->fd, state->row, rowSize))
+        {
+            return false;
+        }
+
+        uint32_t frameY = y - region->y;
+
+        if ((y >= region->y) &&
+            (frameY >= window->y) &&
+            (frameY < window->y + window->height))
+        {
+            state->read(state->row + left,
+                        pixels + frameY * pitch + window->x,
+                        window->width,
+                        state->palette);
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+closeFile(
+    Capture *capture)
+{
+    FileState *state = capture->state;
+
+    if (state->fd != STDIN_FILENO)
+    {
+        close(state->fd);
+    }
+
+    free(state->row);
+    free(state);
+    free(capture);
+}
+
+//-------------------------------------------------------------------------
+
+Capture *
+openFileCapture(
+    const char *path,
+    uint32_t width,
+    uint32_t height,
+    PixelFormat format,
+    const char **error)
+{
+    Capture *capture = calloc(1, sizeof(Capture));
+    FileState *state = calloc(1, sizeof(FileState));
+    uint8_t *row = malloc(width * pixelFormatBytes(format));
+
+    if ((capture == NULL) || (state == NULL) || (row == NULL))
+    {
+        free(capture);
+        free(state);
+        free(row);
+        *error = "cannot allocate file capture";
+        return NULL;
+    }
+
+    state->width = width;
+    state->height = height;
+    state->format = format;
+    state->read = selectPixelReader(format);
+    state->row = row;
+
+    for (int i = 0; i < 256; i++)
+    {
+        state->palette[i] = rgb565(i, i, i);
+    }
+
+    state->fd = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+
+    if (state->fd == -1)
+    {
+        free(capture);
+        free(state);
+        free(row);
+        *error = "cannot open capture file";
+        return NULL;
+    }
+
+    capture->name = "file";
+    capture->width = width;
+    capture->height = height;
+    capture->grab = grabFile;
+    capture->close = closeFile;
+    capture->state = state;
+
+    return capture;
+}
@@ -0,0 +1,527 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+
+#include "capture.h"
+#include "pixelFormat.h"
+
+//-------------------------------------------------------------------------
+
+// Captures the root window of an X server, e.g. a desktop on the HDMI
+// output, or Xvfb for testing. XDamage reports what the clients drew
+// since the last grab; only those rectangles are read, through MIT-SHM
+// (XShmGetImage into a shared memory segment, no copy through the socket),
+// and only they are marked changed for scaling and conversion. A screen
+// where nothing changed costs a round trip to the server. Damage outside
+// a narrowed window is kept and read once the window covers it again.
+//
+// The server must be on the same machine, for the shared memory, with a
+// 16 (RGB565) or 24/32 bit (XRGB8888 or XBGR8888) default visual.
+
+// more damaged rectangles than this are read as their bounding box
+#define X11_MAX_RECTS 16
+
+typedef struct
+{
+    Display *display;
+    Window root;
+    Visual *visual;
+    int depth;
+    uint32_t width;             // of the screen
+    uint32_t height;
+    XShmSegmentInfo shm;
+    XImage *image;              // on the segment, resized for each read
+    bool attached;
+    Damage damage;
+    XserverRegion parts;        // the damage taken at each grab
+    XserverRegion pending;      // damage outside the window, not yet read
+    XserverRegion area;         // the window, in screen pixels
+    PixelFormat format;
+    PixelReader read;
+    bool full;                  // read the whole window at the next grab
+} X11State;
+
+// X reports errors to a handler rather than to the call that caused them
+
+static int lastError = 0;
+
+//-------------------------------------------------------------------------
+
+static int
+handleError(
+    Display *display,
+    XErrorEvent *event)
+{
+    lastError = event->error_code;
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+findFormat(
+    const XImage *image,
+    PixelFormat *format)
+{
+    if (image->byte_order != LSBFirst)
+    {
+        return false;
+    }
+
+    if ((image->bits_per_pixel == 16) &&
+        (image->red_mask == 0xF800) &&
+        (image->green_mask == 0x07E0) &&
+        (image->blue_mask == 0x001F))
+    {
+        *format = PIXEL_FORMAT_RGB565;
+        return true;
+    }
+
+    if ((image->bits_per_pixel != 32) || (image->green_mask != 0x00FF00))
+    {
+        return false;
+    }
+
+    if ((image->red_mask == 0xFF0000) && (image->blue_mask == 0x0000FF))
+    {
+        *format = PIXEL_FORMAT_XRGB8888;
+        return true;
+    }
+
+    *format = PIXEL_FORMAT_XBGR8888;
+    return (image->red_mask == 0x0000FF) && (image->blue_mask == 0xFF0000);
+}
+
+//-------------------------------------------------------------------------
+
+// Reads one rectangle of the window, in frame pixels, through the shared
+// segment into pixels. The screen sized image made at open is shrunk to
+// the rectangle rather than an image made for each one: XShmGetImage()
+// only sends its size, and the server packs the rows at the scanline pad
+// the image was made with.
+
+static bool
+readRect(
+    Capture *capture,
+    const CaptureRect *rect,
+    uint16_t *pixels,
+    uint32_t pitch)
+{
+    X11State *state = capture->state;
+    XImage *image = state->image;
+    uint32_t pad = image->bitmap_pad;
+
+    image->width = rect->width;
+    image->height = rect->height;
+    image->bytes_per_line = (rect->width * image->bits_per_pixel + pad - 1) / pad * (pad / 8);
+
+    lastError = 0;
+
+    bool read = XShmGetImage(state->display,
+                             state->root,
+                             image,
+                             capture->region.x + rect->x,
+                             capture->region.y + rect->y,
+                             AllPlanes) && (lastError == 0);
+
+    for (uint32_t y = 0; read && (y < rect->height); y++)
+    {
+        state->read(image->data + y * image->bytes_per_line,
+                    pixels + (rect->y + y) * pitch + rect->x,
+                    rect->width,
+                    NULL);
+    }
+
+    if (!read)
+    {
+        errno = EIO;
+    }
+
+    return read;
+}
+
+//-------------------------------------------------------------------------
+
+// Clips a damaged rectangle, in screen pixels, to the window. Returns
+// false if nothing of it is left.
+
+static bool
+clipToWindow(
+    const Capture *capture,
+    const XRectangle *damaged,
+    CaptureRect *rect)
+{
+    const CaptureRect *region = &capture->region;
+    const CaptureRect *window = &capture->window;
+
+    int64_t x0 = (int64_t)damaged->x - region->x;
+    int64_t y0 = (int64_t)damaged->y - region->y;
+    int64_t x1 = x0 + damaged->width;
+    int64_t y1 = y0 + damaged->height;
+
+    x0 = (x0 > window->x) ? x0 : window->x;
+    y0 = (y0 > window->y) ? y0 : window->y;
+    x1 = (x1 < window->x + window->width) ? x1 : window->x + window->width;
+    y1 = (y1 < window->y + window->height) ? y1 : window->y + window->height;
+
+    if ((x1 <= x0) || (y1 <= y0))
+    {
+        return false;
+    }
+
+    *rect = (CaptureRect){ x0, y0, x1 - x0, y1 - y0 };
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+grabX11(
+    Capture *capture,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint32_t pitch)
+{
+    X11State *state = capture->state;
+    const CaptureRect *window = &capture->window;
+
+    // the damage events only say there is damage, which is taken anyway
+    while (XPending(state->display) > 0)
+    {
+        XEvent event;
+        XNextEvent(state->display, &event);
+    }
+
+    XRectangle whole =
+    {
+        capture->region.x + window->x,
+        capture->region.y + window->y,
+        window->width,
+        window->height
+    };
+
+    XRectangle region =
+    {
+        capture->region.x,
+        capture->region.y,
+        capture->region.width,
+        capture->region.height
+    };
+
+    // the damage is taken whole; what falls outside the window but inside
+    // the region waits for a grab whose window covers it
+    XDamageSubtract(state->display, state->damage, None, state->parts);
+    XFixesUnionRegion(state->display, state->parts, state->parts, state->pending);
+    XFixesSetRegion(state->display, state->area, &region, 1);
+    XFixesIntersectRegion(state->display, state->parts, state->parts, state->area);
+    XFixesSetRegion(state->display, state->area, &whole, 1);
+    XFixesSubtractRegion(state->display, state->pending, state->parts, state->area);
+    XFixesIntersectRegion(state->display, state->parts, state->parts, state->area);
+
+    int count = 0;
+    XRectangle bounds;
+    XRectangle *damaged = XFixesFetchRegionAndBounds(state->display,
+                                                     state->parts,
+                                                     &count,
+                                                     &bounds);
+
+    const XRectangle *rects = damaged;
+
+    if (state->full)
+    {
+        rects = &whole;
+        count = 1;
+        state->full = false;
+    }
+    else if (count > X11_MAX_RECTS)
+    {
+        rects = &bounds;
+        count = 1;
+    }
+
+    // what was not damaged is as in the previous frame
+    copyOutsideWindow(capture, pixels, prev, pitch);
+
+    for (uint32_t y = window->y; (prev != pixels) && (y < window->y + window->height); y++)
+    {
+        memcpy(pixels + y * pitch + window->x,
+               prev + y * pitch + window->x,
+               window->width * sizeof(uint16_t));
+    }
+
+    uint32_t x0 = capture->width;
+    uint32_t y0 = capture->height;
+    uint32_t x1 = 0;
+    uint32_t y1 = 0;
+    bool grabbed = true;
+
+    for (int i = 0; grabbed && (i < count); i++)
+    {
+        CaptureRect rect;
+
+        if (!clipToWindow(capture, &rects[i], &rect))
+        {
+            continue;
+        }
+
+        grabbed = readRect(capture, &rect, pixels, pitch);
+
+        x0 = (rect.x < x0) ? rect.x : x0;
+        y0 = (rect.y < y0) ? rect.y : y0;
+        x1 = (rect.x + rect.width > x1) ? rect.x + rect.width : x1;
+        y1 = (rect.y + rect.height > y1) ? rect.y + rect.height : y1;
+    }
+
+    if (damaged != NULL)
+    {
+        XFree(damaged);
+    }
+
+    capture->changed = (y1 > y0) ? (CaptureRect){ x0, y0, x1 - x0, y1 - y0 }
+                                 : (CaptureRect){ 0, 0, 0, 0 };
+
+    if (!grabbed)
+    {
+        // the damage taken is lost, read everything next time
+        state->full = true;
+    }
+
+    return grabbed;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+closeX11(
+    Capture *capture)
+{
+    X11State *state = capture->state;
+    int error = errno;  // for the error paths of openX11Capture()
+
+    if (state->display != NULL)
+    {
+        if (state->damage != None)
+        {
+            XDamageDestroy(state->display, state->damage);
+        }
+
+        if (state->parts != None)
+        {
+            XFixesDestroyRegion(state->display, state->parts);
+        }
+
+        if (state->pending != None)
+        {
+            XFixesDestroyRegion(state->display, state->pending);
+        }
+
+        if (state->area != None)
+        {
+            XFixesDestroyRegion(state->display, state->area);
+        }
+
+        if (state->attached)
+        {
+            XShmDetach(state->display, &state->shm);
+        }
+
+        // the data is the shared segment, XDestroyImage() leaves it
+        if (state->image != NULL)
+        {
+            XDestroyImage(state->image);
+        }
+
+        XCloseDisplay(state->display);
+    }
+
+    if ((state->shm.shmaddr != NULL) && (state->shm.shmaddr != (char *)-1))
+    {
+        shmdt(state->shm.shmaddr);
+    }
+
+    free(state);
+    free(capture);
+    errno = error;
+}
+
+//-------------------------------------------------------------------------
+
+Capture *
+openX11Capture(
+    const char *display,
+    const char **error)
+{
+    Capture *capture = calloc(1, sizeof(Capture));
+    X11State *state = calloc(1, sizeof(X11State));
+
+    if ((capture == NULL) || (state == NULL))
+    {
+        free(capture);
+        free(state);
+        *error = "cannot allocate X11 capture";
+        return NULL;
+    }
+
+    capture->name = "x11";
+    capture->grab = grabX11;
+    capture->close = closeX11;
+    capture->state = state;
+
+    XSetErrorHandler(handleError);
+    state->display = XOpenDisplay(display);
+
+    if (state->display == NULL)
+    {
+        closeX11(capture);
+        errno = ECONNREFUSED;
+        *error = "cannot open the X display";
+        return NULL;
+    }
+
+    int eventBase;
+    int errorBase;
+    int major = 2;
+    int minor = 0;
+
+    if (!XShmQueryExtension(state->display) ||
+        !XDamageQueryExtension(state->display, &eventBase, &errorBase) ||
+        !XFixesQueryExtension(state->display, &eventBase, &errorBase) ||
+        !XFixesQueryVersion(state->display, &major, &minor) ||
+        (major < 2))
+    {
+        closeX11(capture);
+        errno = ENOTSUP;
+        *error = "X server lacks MIT-SHM, DAMAGE or XFIXES 2";
+        return NULL;
+    }
+
+    int screen = DefaultScreen(state->display);
+
+    state->root = RootWindow(state->display, screen);
+    state->visual = DefaultVisual(state->display, screen);
+    state->depth = DefaultDepth(state->display, screen);
+    state->width = DisplayWidth(state->display, screen);
+    state->height = DisplayHeight(state->display, screen);
+
+    // an image of the whole screen sizes the segment, gives the format and
+    // is used for every read
+    state->image = XShmCreateImage(state->display,
+                                    state->visual,
+                                    state->depth,
+                                    ZPixmap,
+                                    NULL,
+                                    &state->shm,
+                                    state->width,
+                                    state->height);
+
+    if (state->image == NULL)
+    {
+        closeX11(capture);
+        errno = ENOMEM;
+        *error = "cannot allocate X11 capture";
+        return NULL;
+    }
+
+    size_t size = (size_t)state->image->bytes_per_line * state->height;
+
+    if (!findFormat(state->image, &state->format))
+    {
+        closeX11(capture);
+        errno = ENOTSUP;
+        *error = "X screen pixel format not supported";
+        return NULL;
+    }
+
+    state->shm.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+
+    if (state->shm.shmid == -1)
+    {
+        closeX11(capture);
+        *error = "cannot create X11 shared memory";
+        return NULL;
+    }
+
+    state->shm.shmaddr = shmat(state->shm.shmid, NULL, 0);
+    state->shm.readOnly = False;
+    state->image->data = state->shm.shmaddr;
+
+    // removed now, the segment goes once both sides detach
+    int attachError = (state->shm.shmaddr == (char *)-1) ? errno : 0;
+    shmctl(state->shm.shmid, IPC_RMID, NULL);
+
+    if (attachError != 0)
+    {
+        closeX11(capture);
+        errno = attachError;
+        *error = "cannot map X11 shared memory";
+        return NULL;
+    }
+
+    lastError = 0;
+    state->attached = XShmAttach(state->display, &state->shm);
+    XSync(state->display, False);
+
+    if (!state->attached || (lastError != 0))
+    {
+        state->attached = false;
+        closeX11(capture);
+        errno = EACCES;
+        *error = "X server cannot attach shared memory (is it remote?)";
+        return NULL;
+    }
+
+    state->damage = XDamageCreate(state->display, state->root, XDamageReportNonEmpty);
+    state->parts = XFixesCreateRegion(state->display, NULL, 0);
+    state->pending = XFixesCreateRegion(state->display, NULL, 0);
+    state->area = XFixesCreateRegion(state->display, NULL, 0);
+    state->read = selectPixelReader(state->format);
+    state->full = true;
+
+    capture->width = state->width;
+    capture->height = state->height;
+
+    return capture;
+}
@@ -0,0 +1,610 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+
+#include <linux/kd.h>
+
+#include "console.h"
+
+//-------------------------------------------------------------------------
+
+#define NANOSECONDS_PER_SECOND 1000000000L
+#define NANOSECONDS_PER_MILLISECOND 1000000L
+
+// /dev/vcsa: lines, columns, cursor x and y, then a character and an
+// attribute byte for each cell
+#define VCSA_HEADER 4
+#define VCSA_MAX_SIZE (VCSA_HEADER + 2 * 255 * 255)
+
+// KD_FONT_OP_GET returns glyphs 32 rows apart, whatever their height
+#define FONT_MAX_GLYPHS 512
+#define FONT_MAX_WIDTH 32
+#define FONT_ROWS 32
+
+// glyphs are cached one uint32_t per row
+#define MAX_CELL_WIDTH 32
+
+//-------------------------------------------------------------------------
+
+// Luma of the 16 console colors in the default palette, in the VGA order
+// of the attribute bits (1 is blue, 4 is red).
+
+static const uint8_t colorLuma[16] =
+{
+    0, 19, 100, 119, 51, 70, 101, 170,
+    85, 104, 185, 204, 136, 155, 236, 255
+};
+
+// The output bytes of 4 glyph bits, lowest bit first.
+
+#define NIBBLE(n) \
+    { ((n) & 1) ? 0xFF : 0, ((n) & 2) ? 0xFF : 0, \
+      ((n) & 4) ? 0xFF : 0, ((n) & 8) ? 0xFF : 0 }
+
+static const uint8_t nibbleBytes[16][4] =
+{
+    NIBBLE(0), NIBBLE(1), NIBBLE(2), NIBBLE(3),
+    NIBBLE(4), NIBBLE(5), NIBBLE(6), NIBBLE(7),
+    NIBBLE(8), NIBBLE(9), NIBBLE(10), NIBBLE(11),
+    NIBBLE(12), NIBBLE(13), NIBBLE(14), NIBBLE(15)
+};
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    ConsoleMirror *mirror;
+    int fd;
+    uint8_t *buffer;            // the vcsa device as last read
+
+    // the console grid, and the part of it that fits on the panel
+    uint32_t lines;
+    uint32_t columns;
+    uint32_t shownLines;
+    uint32_t shownColumns;
+    uint32_t cellWidth;
+    uint32_t cellHeight;
+    uint32_t left;              // panel pixels left of and above the grid
+    uint32_t top;
+    uint32_t cursorHeight;      // rows at the bottom of the cursor's cell
+
+    uint32_t glyphs;            // in the font, 256 or 512
+    uint32_t *font;             // cellHeight packed rows for each glyph
+    uint8_t *cells;             // as drawn, 2 bytes each
+    uint32_t cursorX;
+    uint32_t cursorY;
+    bool redraw;                // every cell in the next frame
+    uint32_t drawnLines;        // with a cell drawn in the last frame
+
+    struct timespec due;        // of the next frame, at the earliest
+    uint64_t statsDue;
+} ConsoleState;
+
+//-------------------------------------------------------------------------
+
+static void
+fail(
+    ConsoleState *state,
+    const char *error)
+{
+    state->mirror->error = error;
+    state->mirror->errorNumber = errno;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+recordStage(
+    Stats *stats,
+    Stat stat,
+    uint64_t *clock)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    uint64_t now = statsClock();
+    recordStat(stats, stat, now - *clock);
+
+    *clock = now;
+}
+
+//-------------------------------------------------------------------------
+
+// Packs the font of the console at the size of a cell. Each cell pixel
+// covers a block of font pixels and is set if a third of them are, so
+// strokes one pixel wide survive scaling down.
+
+static bool
+readFont(
+    ConsoleState *state)
+{
+    uint8_t *data = malloc(FONT_MAX_GLYPHS * FONT_ROWS * (FONT_MAX_WIDTH / 8));
+
+    if (data == NULL)
+    {
+        return false;
+    }
+
+    struct console_font_op op =
+    {
+        .op = KD_FONT_OP_GET,
+        .flags = 0,
+        .width = FONT_MAX_WIDTH,
+        .height = FONT_ROWS,
+        .charcount = FONT_MAX_GLYPHS,
+        .data = data
+    };
+
+    int fd = open(state->mirror->fontDevice, O_RDONLY | O_NOCTTY);
+
+    if ((fd == -1) || (ioctl(fd, KDFONTOP, &op) == -1))
+    {
+        int errorNumber = errno;
+
+        if (fd != -1)
+        {
+            close(fd);
+        }
+
+        free(data);
+        errno = errorNumber;
+        return false;
+    }
+
+    close(fd);
+
+    uint32_t cellWidth = state->cellWidth;
+    uint32_t cellHeight = state->cellHeight;
+    uint32_t *font = realloc(state->font,
+                             op.charcount * cellHeight * sizeof(uint32_t));
+
+    if (font == NULL)
+    {
+        free(data);
+        return false;
+    }
+
+    uint32_t rowBytes = (op.width + 7) / 8;
+
+    for (uint32_t glyph = 0; glyph < op.charcount; glyph++)
+    {
+        const uint8_t *rows = data + glyph * FONT_ROWS * rowBytes;
+
+        for (uint32_t cy = 0; cy < cellHeight; cy++)
+        {
+            uint32_t y0 = cy * op.height / cellHeight;
+            uint32_t y1 = (cy + 1) * op.height / cellHeight;
+            uint32_t bits = 0;
+
+            y1 = (y1 > y0) ? y1 : y0 + 1;
+
+            for (uint32_t cx = 0; cx < cellWidth; cx++)
+            {
+                uint32_t x0 = cx * op.width / cellWidth;
+                uint32_t x1 = (cx + 1) * op.width / cellWidth;
+                uint32_t set = 0;
+
+                x1 = (x1 > x0) ? x1 : x0 + 1;
+
+                for (uint32_t y = y0; y < y1; y++)
+                {
+                    for (uint32_t x = x0; x < x1; x++)
+                    {
+                        set += (rows[y * rowBytes + x / 8] >> (7 - x % 8)) & 1;
+                    }
+                }
+
+                if (set * 3 >= (x1 - x0) * (y1 - y0))
+                {
+                    bits |= 1u << cx;
+                }
+            }
+
+            font[glyph * cellHeight + cy] = bits;
+        }
+    }
+
+    free(data);
+
+    state->font = font;
+    state->glyphs = op.charcount;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+// Fits a grid of lines by columns to the panel, packs the font for it
+// and blanks the panel, to be drawn again cell by cell.
+
+static bool
+layOut(
+    ConsoleState *state,
+    uint32_t lines,
+    uint32_t columns)
+{
+    Output *output = state->mirror->output;
+
+    uint32_t cellWidth = (columns > 0) ? output->width / columns : 0;
+    uint32_t cellHeight = (lines > 0) ? output->height / lines : 0;
+
+    cellWidth = (cellWidth > MAX_CELL_WIDTH) ? MAX_CELL_WIDTH : cellWidth;
+    state->cellWidth = (cellWidth > 0) ? cellWidth : 1;
+    state->cellHeight = (cellHeight > 0) ? cellHeight : 1;
+    state->cursorHeight = (state->cellHeight >= 8) ? state->cellHeight / 8 : 1;
+
+    state->lines = lines;
+    state->columns = columns;
+    state->shownColumns = output->width / state->cellWidth;
+    state->shownColumns = (columns < state->shownColumns) ? columns : state->shownColumns;
+    state->shownLines = output->height / state->cellHeight;
+    state->shownLines = (lines < state->shownLines) ? lines : state->shownLines;
+    state->left = (output->width - state->shownColumns * state->cellWidth) / 2;
+    state->top = (output->height - state->shownLines * state->cellHeight) / 2;
+
+    uint8_t *cells = realloc(state->cells, 2 * lines * columns + 1);
+
+    if (cells == NULL)
+    {
+        return false;
+    }
+
+    state->cells = cells;
+
+    if (!readFont(state))
+    {
+        return false;
+    }
+
+    for (uint32_t y = 0; y < output->height; y++)
+    {
+        memset(output->pixels + y * output->pitch, 0, output->width);
+
+        if (output->changedRows != NULL)
+        {
+            output->changedRows[y] = 1;
+        }
+    }
+
+    state->redraw = true;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+drawCell(
+    ConsoleState *state,
+    uint32_t column,
+    uint32_t line,
+    const uint8_t *cell,
+    bool cursor)
+{
+    Output *output = state->mirror->output;
+    uint32_t cellWidth = state->cellWidth;
+    uint32_t cellHeight = state->cellHeight;
+
+    uint32_t glyph = cell[0];
+    uint32_t attribute = cell[1];
+    uint32_t foreground = attribute & 0x0F;
+    uint32_t background = (attribute >> 4) & 0x07;
+
+    if (state->glyphs > 256)
+    {
+        // the bright bit of the foreground picks the upper 256 glyphs
+        glyph |= (attribute & 0x08) << 5;
+        foreground &= 0x07;
+    }
+
+    glyph = (glyph < state->glyphs) ? glyph : 0;
+
+    // the brighter of the two colors is white, both black if they match
+    uint32_t mask = (cellWidth < 32) ? (1u << cellWidth) - 1 : ~0u;
+    uint32_t ink = (colorLuma[foreground] > colorLuma[background]) ? mask : 0;
+    uint32_t paper = (colorLuma[background] > colorLuma[foreground]) ? mask : 0;
+
+    const uint32_t *rows = state->font + glyph * cellHeight;
+    uint32_t y = state->top + line * cellHeight;
+    uint8_t *dst = output->pixels + y * output->pitch +
+                   state->left + column * cellWidth;
+
+    for (uint32_t cy = 0; cy < cellHeight; cy++, dst += output->pitch)
+    {
+        uint32_t bits = (rows[cy] & ink) | (~rows[cy] & paper);
+        uint8_t bytes[MAX_CELL_WIDTH];
+
+        if (cursor && (cy >= cellHeight - state->cursorHeight))
+        {
+            bits ^= mask;
+        }
+
+        for (uint32_t x = 0; x < cellWidth; x += 4)
+        {
+            memcpy(bytes + x, nibbleBytes[(bits >> x) & 0x0F], 4);
+        }
+
+        memcpy(dst, bytes, cellWidth);
+
+        if (output->changedRows != NULL)
+        {
+            output->changedRows[y + cy] = 1;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Reads the console and draws the cells that changed, or the whole grid
+// after a change of size. Returns the number of cells drawn, -1 if the
+// console cannot be read.
+
+static int32_t
+drawConsole(
+    ConsoleState *state,
+    uint64_t *clock)
+{
+    Stats *stats = state->mirror->stats;
+    ssize_t size = pread(state->fd, state->buffer, VCSA_MAX_SIZE, 0);
+
+    if (size < VCSA_HEADER)
+    {
+        errno = (size == -1) ? errno : EIO;
+        fail(state, "cannot read the console");
+        return -1;
+    }
+
+    uint32_t lines = state->buffer[0];
+    uint32_t columns = state->buffer[1];
+    uint32_t cursorX = state->buffer[2];
+    uint32_t cursorY = state->buffer[3];
+
+    if (size < VCSA_HEADER + 2 * lines * columns)
+    {
+        errno = EIO;
+        fail(state, "cannot read the console");
+        return -1;
+    }
+
+    if (((lines != state->lines) || (columns != state->columns)) &&
+        !layOut(state, lines, columns))
+    {
+        fail(state, "cannot read the console font");
+        return -1;
+    }
+
+    recordStage(stats, STAT_CAPTURE, clock);
+
+    bool cursorMoved = (cursorX != state->cursorX) || (cursorY != state->cursorY);
+    size_t lineBytes = 2 * columns;
+    int32_t drawn = 0;
+
+    state->drawnLines = 0;
+
+    for (uint32_t line = 0; line < state->shownLines; line++)
+    {
+        const uint8_t *cells = state->buffer + VCSA_HEADER + line * lineBytes;
+        uint8_t *last = state->cells + line * lineBytes;
+
+        bool cursorLine = cursorMoved &&
+                          ((line == cursorY) || (line == state->cursorY));
+
+        if (!state->redraw &&
+            !cursorLine &&
+            (memcmp(cells, last, 2 * state->shownColumns) == 0))
+        {
+            continue;
+        }
+
+        int32_t drawnBefore = drawn;
+
+        for (uint32_t column = 0; column < state->shownColumns; column++)
+        {
+            const uint8_t *cell = cells + 2 * column;
+            bool cursor = (column == cursorX) && (line == cursorY);
+            bool cursorCell = cursorMoved &&
+                              (cursor ||
+                               ((column == state->cursorX) &&
+                                (line == state->cursorY)));
+
+            if (state->redraw ||
+                cursorCell ||
+                (cell[0] != last[2 * column]) ||
+                (cell[1] != last[2 * column + 1]))
+            {
+                drawCell(state, column, line, cell, cursor);
+                drawn++;
+            }
+        }
+
+        state->drawnLines += (drawn > drawnBefore) ? 1 : 0;
+        memcpy(last, cells, lineBytes);
+    }
+
+    state->cursorX = cursorX;
+    state->cursorY = cursorY;
+    state->redraw = false;
+
+    return drawn;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+flushOutput(
+    ConsoleState *state,
+    uint64_t *clock,
+    uint64_t captured)
+{
+    ConsoleMirror *mirror = state->mirror;
+
+    if (!mirror->output->flush(mirror->output))
+    {
+        fail(state, "cannot write to the display");
+        return false;
+    }
+
+    if (mirror->stats != NULL)
+    {
+        recordStage(mirror->stats, STAT_WRITE, clock);
+        recordStat(mirror->stats, STAT_FRAME, *clock - captured);
+
+        if (*clock >= state->statsDue)
+        {
+            if (!writeStats(mirror->stats) && (mirror->statsError != NULL))
+            {
+                mirror->statsError();
+            }
+
+            state->statsDue = *clock + mirror->statsInterval;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+// Keeps frames at least framePeriod apart, then waits for the console to
+// be written to, or for idlePeriod. Reading the device rearms poll().
+
+static void
+waitForChange(
+    ConsoleState *state)
+{
+    ConsoleMirror *mirror = state->mirror;
+    int64_t total = state->due.tv_nsec + mirror->framePeriod;
+
+    state->due.tv_sec += total / NANOSECONDS_PER_SECOND;
+    state->due.tv_nsec = total % NANOSECONDS_PER_SECOND;
+
+    while ((clock_nanosleep(CLOCK_MONOTONIC,
+                            TIMER_ABSTIME,
+                            &state->due,
+                            NULL) == EINTR) && *mirror->run)
+    {
+        // woken by a signal that does not stop snag
+    }
+
+    struct pollfd poller = { .fd = state->fd, .events = POLLPRI };
+    poll(&poller, 1, mirror->idlePeriod / NANOSECONDS_PER_MILLISECOND);
+
+    // a frame may be due any time after a long wait
+    clock_gettime(CLOCK_MONOTONIC, &state->due);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+runConsoleMirror(
+    ConsoleMirror *mirror)
+{
+    ConsoleState state;
+    memset(&state, 0, sizeof(state));
+
+    state.mirror = mirror;
+    state.cursorX = UINT32_MAX;
+    state.cursorY = UINT32_MAX;
+
+    mirror->error = NULL;
+    mirror->errorNumber = 0;
+
+    state.fd = open(mirror->device, O_RDONLY);
+
+    if (state.fd == -1)
+    {
+        fail(&state, "cannot open the console");
+        return false;
+    }
+
+    state.buffer = malloc(VCSA_MAX_SIZE);
+
+    if (state.buffer == NULL)
+    {
+        fail(&state, "cannot allocate console buffers");
+        close(state.fd);
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &state.due);
+
+    if (mirror->stats != NULL)
+    {
+        state.statsDue = statsClock() + mirror->statsInterval;
+    }
+
+    while (*mirror->run)
+    {
+        uint64_t clock = (mirror->stats != NULL) ? statsClock() : 0;
+        uint64_t captured = clock;
+        int32_t drawn = drawConsole(&state, &clock);
+
+        if (drawn < 0)
+        {
+            break;
+        }
+
+        if (mirror->stats != NULL)
+        {
+            recordStage(mirror->stats, STAT_CONVERT, &clock);
+            recordStat(mirror->stats,
+                       STAT_CHANGED_ROWS,
+                       state.drawnLines * state.cellHeight);
+            recordStat(mirror->stats,
+                       STAT_CHANGED_PIXELS,
+                       drawn * state.cellWidth * state.cellHeight);
+        }
+
+        if (!flushOutput(&state, &clock, captured) || mirror->once)
+        {
+            break;
+        }
+
+        waitForChange(&state);
+    }
+
+    close(state.fd);
+    free(state.buffer);
+    free(state.cells);
+    free(state.font);
+
+    return (mirror->error == NULL);
+}
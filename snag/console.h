@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "output.h"
+#include "stats.h"
+
+//-------------------------------------------------------------------------
+
+// Mirrors a Linux text console by its characters rather than its pixels.
+// Each frame reads the cells of /dev/vcsa<n>, a few KB, compares them with
+// those of the last frame and draws only the cells that changed straight
+// into the output's pixels, from a cache of the console font packed 1 bit
+// per pixel at the size of a panel cell. The grid is fitted to the panel:
+// 80x30 cells are 5x8 pixels on a 400x240 one.
+//
+// Between frames the mirror sleeps in poll() on the vcsa device, which
+// wakes it when the console is written to, and reads the cells again at
+// least every idlePeriod.
+
+typedef struct
+{
+    const char *device;         // /dev/vcsa<n>, the cells
+    const char *fontDevice;     // /dev/tty<n>, for KDFONTOP
+    Output *output;
+    Stats *stats;               // NULL to time nothing
+    int64_t statsInterval;      // nanoseconds between stats writes
+    int64_t framePeriod;        // nanoseconds, the shortest between frames
+    int64_t idlePeriod;         // the longest
+    bool once;                  // one frame only
+    volatile bool *run;         // cleared to stop
+
+    // called with errno set when the stats file cannot be written
+    void (*statsError)(void);
+
+    // why runConsoleMirror() stopped, NULL if run was cleared
+    const char *error;
+    int errorNumber;
+} ConsoleMirror;
+
+//-------------------------------------------------------------------------
+
+// Mirrors the console until run is cleared or reading it or writing the
+// panel fails. Returns false, with error and errorNumber set, if it does.
+
+bool
+runConsoleMirror(
+    ConsoleMirror *mirror);
+
+//-------------------------------------------------------------------------
+
+#endif
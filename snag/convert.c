@@ -0,0 +1,303 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "convert.h"
+#include "rowHash.h"
+
+//-------------------------------------------------------------------------
+
+// Hashes each row and, for rows whose hash changed, finds the changed
+// span by comparing with the previous frame a word (4 pixels) at a time.
+
+static void
+diffRows(
+    void *context,
+    uint32_t y0,
+    uint32_t y1)
+{
+    Converter *converter = context;
+    uint32_t words = converter->width / PIXELS_PER_WORD;
+
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        const uint16_t *newRow = converter->newPixels + y * converter->srcPitch;
+        const uint16_t *oldRow = converter->oldPixels + y * converter->srcPitch;
+        uint32_t *span = converter->spans + 2 * y;
+
+        if (((y < converter->firstRow) || (y >= converter->lastRow)) &&
+            !converter->convertAll)
+        {
+            converter->dirtyRows[y] = 0;
+            span[0] = 0;
+            span[1] = 0;
+            continue;
+        }
+
+        uint64_t hash = hashRow(newRow, converter->width);
+        bool dirty = (hash != converter->rowHashes[y]) || converter->convertAll;
+
+        converter->rowHashes[y] = hash;
+        converter->dirtyRows[y] = dirty;
+        span[0] = 0;
+        span[1] = 0;
+
+        if (!dirty)
+        {
+            continue;
+        }
+
+        span[1] = converter->width;
+
+        if (!converter->convertAll)
+        {
+            uint32_t first = 0;
+            uint32_t last = words;
+
+            while ((first < words) &&
+                   (loadWord(newRow + first * PIXELS_PER_WORD) ==
+                    loadWord(oldRow + first * PIXELS_PER_WORD)))
+            {
+                ++first;
+            }
+
+            while ((last > first) &&
+                   (loadWord(newRow + (last - 1) * PIXELS_PER_WORD) ==
+                    loadWord(oldRow + (last - 1) * PIXELS_PER_WORD)))
+            {
+                --last;
+            }
+
+            // pixels after the last whole word are always converted
+            span[0] = first * PIXELS_PER_WORD;
+            span[1] = (last == words) ? converter->width : last * PIXELS_PER_WORD;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+ditherRows(
+    void *context,
+    uint32_t y0,
+    uint32_t y1)
+{
+    Converter *converter = context;
+
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        const uint32_t *span = converter->spans + 2 * y;
+
+        if (span[0] < span[1])
+        {
+            converter->ditherRow(converter->newPixels + y * converter->srcPitch,
+                                 converter->output + y * converter->dstPitch,
+                                 y,
+                                 span[0],
+                                 span[1]);
+
+            if (converter->changedRows != NULL)
+            {
+                converter->changedRows[y] = 1;
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Both passes over a strip, so a frame needs one run of the workers.
+
+static void
+convertRows(
+    void *context,
+    uint32_t y0,
+    uint32_t y1)
+{
+    diffRows(context, y0, y1);
+    ditherRows(context, y0, y1);
+}
+
+//-------------------------------------------------------------------------
+
+static uint32_t
+countDirtyRows(
+    const Converter *converter)
+{
+    uint32_t dirty = 0;
+
+    for (uint32_t y = 0; y < converter->height; y++)
+    {
+        dirty += converter->dirtyRows[y];
+    }
+
+    return dirty;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initConverter(
+    Converter *converter)
+{
+    converter->rowHashes = calloc(converter->height, sizeof(uint64_t));
+    converter->dirtyRows = calloc(converter->height, 1);
+    converter->spans = calloc(converter->height, 2 * sizeof(uint32_t));
+    converter->convertAll = true;
+    converter->firstRow = 0;
+    converter->lastRow = converter->height;
+
+    return (converter->rowHashes != NULL) &&
+           (converter->dirtyRows != NULL) &&
+           (converter->spans != NULL);
+}
+
+//-------------------------------------------------------------------------
+
+void
+freeConverter(
+    Converter *converter)
+{
+    destroyWorkers(converter->workers);
+    converter->workers = NULL;
+
+    destroyDiffuser(converter->diffuser);
+    converter->diffuser = NULL;
+
+    free(converter->dirtyRows);
+    converter->dirtyRows = NULL;
+
+    free(converter->rowHashes);
+    converter->rowHashes = NULL;
+
+    free(converter->spans);
+    converter->spans = NULL;
+}
+
+//-------------------------------------------------------------------------
+
+uint32_t
+diffFrame(
+    Converter *converter,
+    const uint16_t *newPixels,
+    const uint16_t *oldPixels)
+{
+    converter->newPixels = newPixels;
+    converter->oldPixels = oldPixels;
+
+    if ((converter->workers != NULL) && (converter->diffuser == NULL))
+    {
+        runWorkers(converter->workers, diffRows, converter);
+    }
+    else
+    {
+        diffRows(converter, 0, converter->height);
+    }
+
+    return countDirtyRows(converter);
+}
+
+//-------------------------------------------------------------------------
+
+void
+ditherFrame(
+    Converter *converter,
+    uint8_t *output)
+{
+    converter->output = output;
+
+    if (converter->diffuser != NULL)
+    {
+        diffuseFrame(converter->diffuser,
+                     converter->newPixels,
+                     converter->srcPitch,
+                     converter->dirtyRows,
+                     output,
+                     converter->dstPitch,
+                     converter->changedRows);
+    }
+    else if (converter->workers != NULL)
+    {
+        runWorkers(converter->workers, ditherRows, converter);
+    }
+    else
+    {
+        ditherRows(converter, 0, converter->height);
+    }
+
+    converter->convertAll = false;
+}
+
+//-------------------------------------------------------------------------
+
+uint32_t
+convertFrame(
+    Converter *converter,
+    const uint16_t *newPixels,
+    const uint16_t *oldPixels,
+    uint8_t *output)
+{
+    if ((converter->workers == NULL) || (converter->diffuser != NULL))
+    {
+        uint32_t dirty = diffFrame(converter, newPixels, oldPixels);
+        ditherFrame(converter, output);
+
+        return dirty;
+    }
+
+    converter->newPixels = newPixels;
+    converter->oldPixels = oldPixels;
+    converter->output = output;
+
+    runWorkers(converter->workers, convertRows, converter);
+
+    converter->convertAll = false;
+
+    return countDirtyRows(converter);
+}
+
+//-------------------------------------------------------------------------
+
+uint32_t
+changedPixels(
+    const Converter *converter)
+{
+    uint32_t pixels = 0;
+
+    for (uint32_t y = 0; y < converter->height; y++)
+    {
+        pixels += converter->spans[2 * y + 1] - converter->spans[2 * y];
+    }
+
+    return pixels;
+}
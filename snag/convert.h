@@ -0,0 +1,119 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef CONVERT_H
+#define CONVERT_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "diffuse.h"
+#include "dither.h"
+#include "workers.h"
+
+//-------------------------------------------------------------------------
+
+// Converts captured RGB565 frames to 1-bit output, one byte per pixel.
+// Each source row is hashed 64 bits at a time and skipped when its hash
+// matches the previous frame's; otherwise the row is compared with the
+// previous frame word by word and only the changed span is converted.
+// With workers the rows are split into strips converted in parallel.
+// With a diffuser the changed rows are only flagged, then error diffused
+// on the calling thread from the first one down.
+//
+// convertFrame() runs both passes; diffFrame() and ditherFrame() run them
+// one at a time, for timing each.
+
+typedef struct
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t srcPitch;          // pixels per source row
+    uint32_t dstPitch;          // bytes per output row
+    DitherRowKernel ditherRow;
+    Workers *workers;           // NULL to convert on the calling thread
+    Diffuser *diffuser;         // error diffusion instead of ditherRow
+    uint8_t *dirtyRows;         // rows whose hash changed in the last frame
+    uint32_t *spans;            // changed x0, x1 of each row, equal if none
+    uint64_t *rowHashes;        // hash of each row of the previous frame
+    bool convertAll;            // convert every row of the next frame
+    uint32_t firstRow;          // rows outside firstRow to lastRow are the
+    uint32_t lastRow;           // same in the next frame, not even hashed
+    uint8_t *changedRows;       // optional, set to 1 for each row converted
+
+    // set for each frame by convertFrame()
+    const uint16_t *newPixels;
+    const uint16_t *oldPixels;
+    uint8_t *output;
+} Converter;
+
+//-------------------------------------------------------------------------
+
+// Allocates the row hashes once width, height and srcPitch are set, and
+// looks at every row of each frame until firstRow and lastRow are set.
+
+bool
+initConverter(
+    Converter *converter);
+
+void
+freeConverter(
+    Converter *converter);
+
+// Converts the rows that changed since oldPixels. Returns the number of
+// rows that differ from the previous frame, 0 for a static screen.
+
+uint32_t
+convertFrame(
+    Converter *converter,
+    const uint16_t *newPixels,
+    const uint16_t *oldPixels,
+    uint8_t *output);
+
+uint32_t
+diffFrame(
+    Converter *converter,
+    const uint16_t *newPixels,
+    const uint16_t *oldPixels);
+
+void
+ditherFrame(
+    Converter *converter,
+    uint8_t *output);
+
+// Pixels in the changed spans of the last frame.
+
+uint32_t
+changedPixels(
+    const Converter *converter);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,301 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diffuse.h"
+#include "luma.h"
+
+//-------------------------------------------------------------------------
+
+// gray levels are carried with 4 fractional bits
+#define ERROR_SHIFT 4
+#define THRESHOLD (128 << ERROR_SHIFT)
+#define WHITE (255 << ERROR_SHIFT)
+
+// scratch rows have room for the error pushed past either edge
+#define PAD 2
+
+//-------------------------------------------------------------------------
+
+struct Diffuser
+{
+    Diffusion diffusion;
+    uint32_t width;
+    uint32_t height;
+
+    // error carried into each row by the rows above, as of the last frame
+    int16_t *carried;
+
+    // Atkinson only: the part of carried[y] that came from row y-2
+    int16_t *skipped;
+
+    // rows being diffused: the current row and the next two
+    int16_t *scratch[3];
+};
+
+//-------------------------------------------------------------------------
+
+static int16_t *
+carriedRow(
+    const Diffuser *diffuser,
+    int16_t *rows,
+    uint32_t y)
+{
+    return rows + y * diffuser->width;
+}
+
+//-------------------------------------------------------------------------
+
+// Dithers one row. current holds the error carried into it and collects
+// the error pushed right along the row; next and after collect the error
+// pushed into the two rows below.
+
+static void
+diffuseRow(
+    Diffusion diffusion,
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t width,
+    int16_t *current,
+    int16_t *next,
+    int16_t *after)
+{
+    // signed so that x - 1 reaches the left padding
+    for (int32_t x = 0; x < (int32_t)width; x++)
+    {
+        int32_t value = (lumaTable[src[x]] << ERROR_SHIFT) + current[x];
+        // dividing (rather than shifting) rounds towards zero, so what is
+        // left of a disturbance dies out in flat areas instead of being
+        // carried down to the bottom of the screen as -1s
+        uint8_t white = value >= THRESHOLD;
+        int32_t error = value - (white ? WHITE : 0);
+
+        dst[x] = white;
+
+        if (diffusion == DIFFUSION_FLOYD_STEINBERG)
+        {
+            current[x + 1] += (error * 7) / 16;
+            next[x - 1] += (error * 3) / 16;
+            next[x] += (error * 5) / 16;
+            next[x + 1] += error / 16;
+        }
+        else
+        {
+            // Atkinson passes on 6/8 of the error
+            int32_t part = error / 8;
+
+            current[x + 1] += part;
+            current[x + 2] += part;
+            next[x - 1] += part;
+            next[x] += part;
+            next[x + 1] += part;
+            after[x] += part;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Loads a scratch row from a stored row, with cleared padding.
+
+static void
+loadRow(
+    int16_t *scratch,
+    const int16_t *row,
+    uint32_t width)
+{
+    memset(scratch - PAD, 0, (width + 2 * PAD) * sizeof(int16_t));
+
+    if (row != NULL)
+    {
+        memcpy(scratch, row, width * sizeof(int16_t));
+    }
+}
+
+//-------------------------------------------------------------------------
+
+Diffuser *
+createDiffuser(
+    Diffusion diffusion,
+    uint32_t width,
+    uint32_t height)
+{
+    Diffuser *diffuser = calloc(1, sizeof(Diffuser));
+
+    if (diffuser == NULL)
+    {
+        return NULL;
+    }
+
+    diffuser->diffusion = diffusion;
+    diffuser->width = width;
+    diffuser->height = height;
+    diffuser->carried = calloc(width * height, sizeof(int16_t));
+
+    bool ok = diffuser->carried != NULL;
+
+    if (diffusion == DIFFUSION_ATKINSON)
+    {
+        diffuser->skipped = calloc(width * height, sizeof(int16_t));
+        ok = ok && (diffuser->skipped != NULL);
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        int16_t *row = calloc(width + 2 * PAD, sizeof(int16_t));
+        diffuser->scratch[i] = (row != NULL) ? row + PAD : NULL;
+        ok = ok && (row != NULL);
+    }
+
+    if (!ok)
+    {
+        destroyDiffuser(diffuser);
+        return NULL;
+    }
+
+    return diffuser;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyDiffuser(
+    Diffuser *diffuser)
+{
+    if (diffuser == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (diffuser->scratch[i] != NULL)
+        {
+            free(diffuser->scratch[i] - PAD);
+        }
+    }
+
+    free(diffuser->skipped);
+    free(diffuser->carried);
+    free(diffuser);
+}
+
+//-------------------------------------------------------------------------
+
+uint32_t
+diffuseFrame(
+    Diffuser *diffuser,
+    const uint16_t *pixels,
+    uint32_t srcPitch,
+    const uint8_t *dirtyRows,
+    uint8_t *output,
+    uint32_t dstPitch,
+    uint8_t *changedRows)
+{
+    uint32_t width = diffuser->width;
+    uint32_t height = diffuser->height;
+    bool atkinson = diffuser->diffusion == DIFFUSION_ATKINSON;
+    size_t rowSize = width * sizeof(int16_t);
+    uint32_t dithered = 0;
+    uint32_t y = 0;
+
+    while (y < height)
+    {
+        if (!dirtyRows[y])
+        {
+            ++y;
+            continue;
+        }
+
+        // resume from the error the rows above carried last frame
+        int16_t *current = diffuser->scratch[0];
+        int16_t *next = diffuser->scratch[1];
+        int16_t *after = diffuser->scratch[2];
+
+        loadRow(current, carriedRow(diffuser, diffuser->carried, y), width);
+        loadRow(next,
+                (atkinson && (y + 1 < height))
+                    ? carriedRow(diffuser, diffuser->skipped, y + 1)
+                    : NULL,
+                width);
+        loadRow(after, NULL, width);
+
+        for (;;)
+        {
+            diffuseRow(diffuser->diffusion,
+                       pixels + y * srcPitch,
+                       output + y * dstPitch,
+                       width,
+                       current,
+                       next,
+                       after);
+
+            ++dithered;
+
+            if (changedRows != NULL)
+            {
+                changedRows[y] = 1;
+            }
+
+            if (++y == height)
+            {
+                break;
+            }
+
+            // stop once the rows below get the same error as last frame
+            int16_t *carried = carriedRow(diffuser, diffuser->carried, y);
+            bool converged = !dirtyRows[y] && (memcmp(next, carried, rowSize) == 0);
+
+            memcpy(carried, next, rowSize);
+
+            if (atkinson && (y + 1 < height))
+            {
+                int16_t *skipped = carriedRow(diffuser, diffuser->skipped, y + 1);
+                converged = converged && (memcmp(after, skipped, rowSize) == 0);
+                memcpy(skipped, after, rowSize);
+            }
+
+            if (converged)
+            {
+                break;
+            }
+
+            int16_t *done = current;
+            current = next;
+            next = after;
+            after = done;
+            loadRow(after, NULL, width);
+        }
+    }
+
+    return dithered;
+}
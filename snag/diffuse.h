@@ -0,0 +1,77 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef DIFFUSE_H
+#define DIFFUSE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#include "dither.h"
+
+//-------------------------------------------------------------------------
+
+// Incremental error diffusion. The error carried into each row (in 1/16
+// gray levels) is kept from one frame to the next, so a frame is only
+// re-dithered from its first dirty row, and only until the error carried
+// into the following rows is the same as in the previous frame. Below
+// that point the previous output is still right, up to the next dirty row.
+
+typedef struct Diffuser Diffuser;
+
+//-------------------------------------------------------------------------
+
+Diffuser *
+createDiffuser(
+    Diffusion diffusion,
+    uint32_t width,
+    uint32_t height);
+
+void
+destroyDiffuser(
+    Diffuser *diffuser);
+
+// Re-dithers the rows of pixels (RGB565) into output (one byte per pixel)
+// starting at each row flagged in dirtyRows. Sets changedRows[y] for each
+// row written if changedRows is not NULL. Returns the number of rows
+// dithered.
+
+uint32_t
+diffuseFrame(
+    Diffuser *diffuser,
+    const uint16_t *pixels,
+    uint32_t srcPitch,
+    const uint8_t *dirtyRows,
+    uint8_t *output,
+    uint32_t dstPitch,
+    uint8_t *changedRows);
+
+//-------------------------------------------------------------------------
+
+#endif
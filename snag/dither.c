@@ -0,0 +1,292 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#include "dither.h"
+#include "luma.h"
+
+//-------------------------------------------------------------------------
+
+// define bayer dither patterns
+const uint8_t BAYER2X2[2][2] =
+{    //    2x2 Bayer Dithering Matrix. Color levels: 5
+    {  51, 206 },
+    { 153, 102 }
+};
+
+const uint8_t BAYER3X3[3][3] =
+{    //    3x3 Bayer Dithering Matrix. Color levels: 10
+    {  75, 150, 225 },
+    {  50, 125, 200 },
+    {  25, 100, 175 }
+};
+
+const uint8_t BAYER4X4[4][4] =
+{    //    4x4 Bayer Dithering Matrix. Color levels: 17
+    {  15, 195,  60, 240 },
+    { 135,  75, 180, 120 },
+    {  45, 225,  30, 210 },
+    { 165, 105, 150,  90 }
+};
+
+const uint8_t BAYER8X8[8][8] =
+{    //    8x8 Bayer Dithering Matrix. Color levels: 65
+    {   0, 128,  32, 160,   8, 136,  40, 168 },
+    { 192,  64, 224,  96, 200,  72, 232, 104 },
+    {  48, 176,  16, 144,  56, 184,  24, 152 },
+    { 240, 112, 208,  80, 248, 120, 216,  88 },
+    {  12, 140,  44, 172,   4, 132,  36, 164 },
+    { 204,  76, 236, 108, 196,  68, 228, 100 },
+    {  60, 188,  28, 156,  52, 180,  20, 148 },
+    { 252, 124, 220,  92, 244, 116, 212,  84 }
+};
+
+const uint8_t BAYER16X16[16][16] =
+{    //    16x16 Bayer Dithering Matrix.  Color levels: 256
+    {   0, 191,  48, 239,  12, 203,  60, 251,   3, 194,  51, 242,  15, 206,  63, 254 },
+    { 127,  64, 175, 112, 139,  76, 187, 124, 130,  67, 178, 115, 142,  79, 190, 127 },
+    {  32, 223,  16, 207,  44, 235,  28, 219,  35, 226,  19, 210,  47, 238,  31, 222 },
+    { 159,  96, 143,  80, 171, 108, 155,  92, 162,  99, 146,  83, 174, 111, 158,  95 },
+    {   8, 199,  56, 247,   4, 195,  52, 243,  11, 202,  59, 250,   7, 198,  55, 246 },
+    { 135,  72, 183, 120, 131,  68, 179, 116, 138,  75, 186, 123, 134,  71, 182, 119 },
+    {  40, 231,  24, 215,  36, 227,  20, 211,  43, 234,  27, 218,  39, 230,  23, 214 },
+    { 167, 104, 151,  88, 163, 100, 147,  84, 170, 107, 154,  91, 166, 103, 150,  87 },
+    {   2, 193,  50, 241,  14, 205,  62, 253,   1, 192,  49, 240,  13, 204,  61, 252 },
+    { 129,  66, 177, 114, 141,  78, 189, 126, 128,  65, 176, 113, 140,  77, 188, 125 },
+    {  34, 225,  18, 209,  46, 237,  30, 221,  33, 224,  17, 208,  45, 236,  29, 220 },
+    { 161,  98, 145,  82, 173, 110, 157,  94, 160,  97, 144,  81, 172, 109, 156,  93 },
+    {  10, 201,  58, 249,   6, 197,  54, 245,   9, 200,  57, 248,   5, 196,  53, 244 },
+    { 137,  74, 185, 122, 133,  70, 181, 118, 136,  73, 184, 121, 132,  69, 180, 117 },
+    {  42, 233,  26, 217,  38, 229,  22, 213,  41, 232,  25, 216,  37, 228,  21, 212 },
+    { 169, 106, 153,  90, 165, 102, 149,  86, 168, 105, 152,  89, 164, 101, 148,  85 }
+};
+
+//-------------------------------------------------------------------------
+
+// One kernel per power-of-two matrix: the threshold row is fixed for the
+// whole call and the column index is a constant mask.
+
+#define BAYER_ROW_KERNEL(N)                                                \
+static void                                                               \
+ditherRowBayer##N(                                                        \
+    const uint16_t *src,                                                  \
+    uint8_t *dst,                                                         \
+    uint32_t y,                                                           \
+    uint32_t x0,                                                          \
+    uint32_t x1)                                                          \
+{                                                                         \
+    const uint8_t *threshold = BAYER##N##X##N[y & (N - 1)];               \
+                                                                          \
+    for (uint32_t x = x0; x < x1; x++)                                    \
+    {                                                                     \
+        dst[x] = lumaTable[src[x]] >= threshold[x & (N - 1)];             \
+    }                                                                     \
+}
+
+BAYER_ROW_KERNEL(2)
+BAYER_ROW_KERNEL(4)
+BAYER_ROW_KERNEL(8)
+BAYER_ROW_KERNEL(16)
+
+//-------------------------------------------------------------------------
+
+static void
+ditherRowBayer3(
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t y,
+    uint32_t x0,
+    uint32_t x1)
+{
+    const uint8_t *threshold = BAYER3X3[y % 3];
+    uint32_t column = x0 % 3;
+
+    for (uint32_t x = x0; x < x1; x++)
+    {
+        dst[x] = lumaTable[src[x]] >= threshold[column];
+
+        if (++column == 3)
+        {
+            column = 0;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Same cost as the Bayer kernels, but the thresholds have no regular
+// structure so there is no crosshatch.
+
+static void
+ditherRowBlueNoise(
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t y,
+    uint32_t x0,
+    uint32_t x1)
+{
+    const uint8_t *threshold = BLUE_NOISE64X64[y & 63];
+
+    for (uint32_t x = x0; x < x1; x++)
+    {
+        dst[x] = lumaTable[src[x]] >= threshold[x & 63];
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+ditherRowNone(
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t y,
+    uint32_t x0,
+    uint32_t x1)
+{
+    for (uint32_t x = x0; x < x1; x++)
+    {
+        dst[x] = lumaTable[src[x]] >= THRESHOLD_NONE;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static const DitherMethod ditherMethods[] =
+{
+    { "none", 1, ditherRowNone, DIFFUSION_NONE },
+    { "2x2", 2, ditherRowBayer2, DIFFUSION_NONE },
+    { "3x3", 3, ditherRowBayer3, DIFFUSION_NONE },
+    { "4x4", 4, ditherRowBayer4, DIFFUSION_NONE },
+    { "8x8", 8, ditherRowBayer8, DIFFUSION_NONE },
+    { "16x16", 16, ditherRowBayer16, DIFFUSION_NONE },
+    { "bluenoise", 64, ditherRowBlueNoise, DIFFUSION_NONE },
+    { "floyd-steinberg", 1, NULL, DIFFUSION_FLOYD_STEINBERG },
+    { "atkinson", 1, NULL, DIFFUSION_ATKINSON },
+};
+
+//-------------------------------------------------------------------------
+
+const DitherMethod *
+findDitherMethod(
+    const char *name)
+{
+    size_t count = sizeof(ditherMethods) / sizeof(ditherMethods[0]);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(ditherMethods[i].name, name) == 0)
+        {
+            return &ditherMethods[i];
+        }
+    }
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+const DitherMethod *
+ditherMethodAt(
+    size_t index)
+{
+    size_t count = sizeof(ditherMethods) / sizeof(ditherMethods[0]);
+
+    return (index < count) ? &ditherMethods[index] : NULL;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+cpuHasNeon(void)
+{
+#if defined(__aarch64__)
+    return true;
+#elif defined(__arm__)
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+    return false;
+#endif
+}
+
+//-------------------------------------------------------------------------
+
+DitherRowKernel
+neonDitherKernel(
+    const char *name)
+{
+    if (!cpuHasNeon())
+    {
+        return NULL;
+    }
+
+    for (const NeonDitherKernel *kernel = neonDitherKernels;
+         kernel->name != NULL;
+         kernel++)
+    {
+        if (strcmp(kernel->name, name) == 0)
+        {
+            return kernel->row;
+        }
+    }
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+DitherRowKernel
+selectDitherKernel(
+    const DitherMethod *method,
+    bool linearLuma)
+{
+    if (method->diffusion != DIFFUSION_NONE)
+    {
+        return NULL;
+    }
+
+    if (linearLuma)
+    {
+        DitherRowKernel simd = neonDitherKernel(method->name);
+
+        if (simd != NULL)
+        {
+            return simd;
+        }
+    }
+
+    return method->row;
+}
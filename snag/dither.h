@@ -0,0 +1,134 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef DITHER_H
+#define DITHER_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Converts pixels x0 to x1-1 of row y from RGB565 (src) to 1-bit values
+// (dst, one byte per pixel). src and dst point at the start of the row.
+
+typedef void
+(*DitherRowKernel)(
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t y,
+    uint32_t x0,
+    uint32_t x1);
+
+// Error diffusion methods have no row kernel: each row depends on the
+// error carried from the rows above, so they are run by a Diffuser
+// (diffuse.h) instead.
+
+typedef enum
+{
+    DIFFUSION_NONE,
+    DIFFUSION_FLOYD_STEINBERG,
+    DIFFUSION_ATKINSON
+} Diffusion;
+
+typedef struct
+{
+    const char *name;
+    uint32_t period;    // rows after which the threshold pattern repeats
+    DitherRowKernel row;
+    Diffusion diffusion;
+} DitherMethod;
+
+//-------------------------------------------------------------------------
+
+// Threshold matrices, shared with the SIMD kernels
+
+#define THRESHOLD_NONE 140
+
+extern const uint8_t BAYER2X2[2][2];
+extern const uint8_t BAYER3X3[3][3];
+extern const uint8_t BAYER4X4[4][4];
+extern const uint8_t BAYER8X8[8][8];
+extern const uint8_t BAYER16X16[16][16];
+
+// tileable blue-noise texture (blueNoise.c, made by blueNoise.py)
+extern const uint8_t BLUE_NOISE64X64[64][64];
+
+//-------------------------------------------------------------------------
+
+// Returns the method called name, or NULL if there is none.
+
+const DitherMethod *
+findDitherMethod(
+    const char *name);
+
+// Returns the index-th method, or NULL past the last one.
+
+const DitherMethod *
+ditherMethodAt(
+    size_t index);
+
+// Returns the fastest row kernel for method on this CPU. The SIMD kernels
+// compute luma directly rather than through lumaTable, so they are only
+// used when the table has no gamma/contrast curve folded in. Returns NULL
+// for error diffusion methods.
+
+DitherRowKernel
+selectDitherKernel(
+    const DitherMethod *method,
+    bool linearLuma);
+
+// True if the CPU has NEON, so the kernels in ditherNeon.c may run.
+
+bool
+cpuHasNeon(void);
+
+// NEON kernel for the method called name, or NULL if the CPU has no NEON
+// or the method has no NEON kernel.
+
+DitherRowKernel
+neonDitherKernel(
+    const char *name);
+
+// The NEON kernels (ditherNeon.c), ended by an entry with a NULL name.
+// Only the end marker unless built with NEON.
+
+typedef struct
+{
+    const char *name;
+    DitherRowKernel row;
+} NeonDitherKernel;
+
+extern const NeonDitherKernel neonDitherKernels[];
+
+//-------------------------------------------------------------------------
+
+#endif
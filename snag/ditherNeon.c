@@ -0,0 +1,272 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+// NEON row kernels, and pixel format readers (pixelFormat.h), for armv7
+// (Pi Zero 2, Pi 3/4 running 32-bit) and aarch64 builds. On 32-bit ARM
+// this file alone is built with NEON enabled, so it holds only the
+// kernels and the tables listing them: no code in it runs until
+// cpuHasNeon() (dither.c, built for the baseline) has checked the CPU,
+// and the same binary still runs on an ARMv6 Pi Zero.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dither.h"
+#include "pixelFormat.h"
+
+#if defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+#include "luma.h"
+
+//-------------------------------------------------------------------------
+
+// Gray levels of 8 RGB565 pixels, same arithmetic as buildLumaTable()
+// without a curve.
+
+static inline uint8x8_t
+lumaNeon(
+    uint16x8_t pixels)
+{
+    uint8x8_t red = vmovn_u16(vshrq_n_u16(pixels, 11));
+    uint8x8_t green = vand_u8(vshrn_n_u16(pixels, 5), vdup_n_u8(0x3F));
+    uint8x8_t blue = vand_u8(vmovn_u16(pixels), vdup_n_u8(0x1F));
+
+    // Expand the 5-bit and 6-bit components to 8-bit values
+    red = vorr_u8(vshl_n_u8(red, 3), vshr_n_u8(red, 2));
+    green = vorr_u8(vshl_n_u8(green, 2), vshr_n_u8(green, 4));
+    blue = vorr_u8(vshl_n_u8(blue, 3), vshr_n_u8(blue, 2));
+
+    uint16x8_t sum = vmull_u8(red, vdup_n_u8(LUMA_WEIGHT_RED));
+    sum = vmlal_u8(sum, green, vdup_n_u8(LUMA_WEIGHT_GREEN));
+    sum = vmlal_u8(sum, blue, vdup_n_u8(LUMA_WEIGHT_BLUE));
+
+    return vshrn_n_u16(sum, 8);
+}
+
+//-------------------------------------------------------------------------
+
+// 16 pixels per step. Matrices are at most 16 wide and a power of two, so
+// the 16 thresholds under the vector are the same at every step.
+
+static inline void
+ditherRowNeon(
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t x0,
+    uint32_t x1,
+    const uint8_t *threshold,
+    uint32_t mask)
+{
+    uint8_t pattern[16];
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        pattern[i] = threshold[(x0 + i) & mask];
+    }
+
+    uint8x16_t thresholds = vld1q_u8(pattern);
+    uint8x16_t one = vdupq_n_u8(1);
+    uint32_t x = x0;
+
+    for ( ; x + 16 <= x1; x += 16)
+    {
+        uint8x8_t low = lumaNeon(vld1q_u16(src + x));
+        uint8x8_t high = lumaNeon(vld1q_u16(src + x + 8));
+        uint8x16_t gray = vcombine_u8(low, high);
+
+        vst1q_u8(dst + x, vandq_u8(vcgeq_u8(gray, thresholds), one));
+    }
+
+    for ( ; x < x1; x++)
+    {
+        dst[x] = lumaTable[src[x]] >= threshold[x & mask];
+    }
+}
+
+//-------------------------------------------------------------------------
+
+#define NEON_ROW_KERNEL(N)                                                 \
+static void                                                               \
+ditherRowBayer##N##Neon(                                                  \
+    const uint16_t *src,                                                  \
+    uint8_t *dst,                                                         \
+    uint32_t y,                                                           \
+    uint32_t x0,                                                          \
+    uint32_t x1)                                                          \
+{                                                                         \
+    ditherRowNeon(src, dst, x0, x1, BAYER##N##X##N[y & (N - 1)], N - 1);  \
+}
+
+NEON_ROW_KERNEL(2)
+NEON_ROW_KERNEL(4)
+NEON_ROW_KERNEL(8)
+NEON_ROW_KERNEL(16)
+
+// The blue-noise rows are 64 wide: once x is a multiple of 16 the next 16
+// thresholds are contiguous and can be loaded directly.
+
+static void
+ditherRowBlueNoiseNeon(
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t y,
+    uint32_t x0,
+    uint32_t x1)
+{
+    const uint8_t *threshold = BLUE_NOISE64X64[y & 63];
+    uint8x16_t one = vdupq_n_u8(1);
+    uint32_t x = x0;
+
+    for ( ; (x < x1) && (x & 15); x++)
+    {
+        dst[x] = lumaTable[src[x]] >= threshold[x & 63];
+    }
+
+    for ( ; x + 16 <= x1; x += 16)
+    {
+        uint8x8_t low = lumaNeon(vld1q_u16(src + x));
+        uint8x8_t high = lumaNeon(vld1q_u16(src + x + 8));
+        uint8x16_t gray = vcombine_u8(low, high);
+        uint8x16_t thresholds = vld1q_u8(threshold + (x & 63));
+
+        vst1q_u8(dst + x, vandq_u8(vcgeq_u8(gray, thresholds), one));
+    }
+
+    for ( ; x < x1; x++)
+    {
+        dst[x] = lumaTable[src[x]] >= threshold[x & 63];
+    }
+}
+
+static void
+ditherRowNoneNeon(
+    const uint16_t *src,
+    uint8_t *dst,
+    uint32_t y,
+    uint32_t x0,
+    uint32_t x1)
+{
+    static const uint8_t threshold[1] = { THRESHOLD_NONE };
+
+    ditherRowNeon(src, dst, x0, x1, threshold, 0);
+}
+
+//-------------------------------------------------------------------------
+
+const NeonDitherKernel neonDitherKernels[] =
+{
+    { "none", ditherRowNoneNeon },
+    { "2x2", ditherRowBayer2Neon },
+    { "4x4", ditherRowBayer4Neon },
+    { "8x8", ditherRowBayer8Neon },
+    { "16x16", ditherRowBayer16Neon },
+    { "bluenoise", ditherRowBlueNoiseNeon },
+    { NULL, NULL }
+};
+
+//-------------------------------------------------------------------------
+
+// Packs 8 pixels to RGB565: each channel is widened into the top byte of
+// a lane, then shifted right and inserted under the bits kept above it.
+
+static inline uint16x8_t
+packRgb565Neon(
+    uint8x8_t red,
+    uint8x8_t green,
+    uint8x8_t blue)
+{
+    uint16x8_t pixels = vshll_n_u8(red, 8);
+
+    pixels = vsriq_n_u16(pixels, vshll_n_u8(green, 8), 5);
+
+    return vsriq_n_u16(pixels, vshll_n_u8(blue, 8), 11);
+}
+
+//-------------------------------------------------------------------------
+
+// 16 pixels per step, the load splitting them into their channels.
+// Byte 0 of an XRGB8888 pixel is blue, of an XBGR8888 pixel red.
+
+#define NEON_READER(NAME, RED, BLUE)                                \
+static void                                                         \
+read##NAME##Neon(                                                   \
+    const void *src,                                                \
+    uint16_t *dst,                                                  \
+    uint32_t count,                                                 \
+    const uint16_t *palette)                                        \
+{                                                                   \
+    const uint8_t *bytes = src;                                     \
+    uint32_t x = 0;                                                 \
+                                                                    \
+    for ( ; x + 16 <= count; x += 16)                               \
+    {                                                               \
+        uint8x16x4_t pixels = vld4q_u8(bytes + 4 * x);              \
+        uint8x16_t red = pixels.val[RED];                           \
+        uint8x16_t green = pixels.val[1];                           \
+        uint8x16_t blue = pixels.val[BLUE];                         \
+                                                                    \
+        vst1q_u16(dst + x, packRgb565Neon(vget_low_u8(red),         \
+                                          vget_low_u8(green),       \
+                                          vget_low_u8(blue)));      \
+        vst1q_u16(dst + x + 8, packRgb565Neon(vget_high_u8(red),    \
+                                              vget_high_u8(green),  \
+                                              vget_high_u8(blue))); \
+    }                                                               \
+                                                                    \
+    for ( ; x < count; x++)                                         \
+    {                                                               \
+        const uint8_t *p = bytes + 4 * x;                           \
+                                                                    \
+        dst[x] = rgb565(p[RED], p[1], p[BLUE]);                     \
+    }                                                               \
+}
+
+NEON_READER(Xrgb8888, 2, 0)
+NEON_READER(Xbgr8888, 0, 2)
+
+//-------------------------------------------------------------------------
+
+// RGB565 is a memcpy, palette lookups do not vectorise
+
+const NeonPixelReader neonPixelReaders[] =
+{
+    { PIXEL_FORMAT_XRGB8888, readXrgb8888Neon },
+    { PIXEL_FORMAT_XBGR8888, readXbgr8888Neon },
+    { PIXEL_FORMAT_RGB565, NULL }
+};
+
+#else
+
+//-------------------------------------------------------------------------
+
+const NeonDitherKernel neonDitherKernels[] = { { NULL, NULL } };
+const NeonPixelReader neonPixelReaders[] = { { PIXEL_FORMAT_RGB565, NULL } };
+
+#endif
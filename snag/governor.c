@@ -0,0 +1,182 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "governor.h"
+
+//-------------------------------------------------------------------------
+
+#define NANOSECONDS_PER_SECOND 1000000000L
+
+// the rate goes up once under GOVERNOR_HEADROOM of the budget, and shed
+// work comes back under GOVERNOR_RESTORE of it
+#define GOVERNOR_HEADROOM 0.8
+#define GOVERNOR_RESTORE 0.5
+
+// the most the period changes in one window
+#define GOVERNOR_MAX_STEP 2.0
+
+// a settled rate is reported when this far from the last one reported
+#define GOVERNOR_REPORT_CHANGE 0.1
+
+//-------------------------------------------------------------------------
+
+static uint64_t
+readClock(
+    clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return (uint64_t)now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
+
+//-------------------------------------------------------------------------
+
+// The next level up that the governor may shed, or level if none.
+
+static GovernorLevel
+shedMore(
+    const Governor *governor,
+    GovernorLevel level)
+{
+    if ((level < GOVERNOR_REGION) && governor->shedRegion)
+    {
+        return GOVERNOR_REGION;
+    }
+
+    if ((level < GOVERNOR_DITHER) && governor->shedDither)
+    {
+        return GOVERNOR_DITHER;
+    }
+
+    return level;
+}
+
+//-------------------------------------------------------------------------
+
+static GovernorLevel
+shedLess(
+    const Governor *governor,
+    GovernorLevel level)
+{
+    if ((level == GOVERNOR_DITHER) && governor->shedRegion)
+    {
+        return GOVERNOR_REGION;
+    }
+
+    return GOVERNOR_REDUCED_RATE;
+}
+
+//-------------------------------------------------------------------------
+
+void
+initGovernor(
+    Governor *governor)
+{
+    governor->period = governor->minPeriod;
+    governor->reportedPeriod = governor->minPeriod;
+    governor->used = 0.0;
+    atomic_init(&governor->level, GOVERNOR_FULL_RATE);
+
+    governor->windowStart = readClock(CLOCK_MONOTONIC);
+    governor->cpuStart = readClock(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+updateGovernor(
+    Governor *governor)
+{
+    uint64_t now = readClock(CLOCK_MONOTONIC);
+    uint64_t wall = now - governor->windowStart;
+
+    if (wall < GOVERNOR_WINDOW_SECONDS * NANOSECONDS_PER_SECOND)
+    {
+        return false;
+    }
+
+    uint64_t cpu = readClock(CLOCK_PROCESS_CPUTIME_ID);
+
+    governor->used = (double)(cpu - governor->cpuStart) / wall;
+    governor->windowStart = now;
+    governor->cpuStart = cpu;
+
+    GovernorLevel level = atomic_load(&governor->level);
+    GovernorLevel next = level;
+    int64_t lastPeriod = governor->period;
+    double ratio = governor->used / governor->budget;
+
+    if (ratio > 1.0)
+    {
+        if (governor->period >= governor->maxPeriod)
+        {
+            next = shedMore(governor, level);
+        }
+        else
+        {
+            double step = (ratio < GOVERNOR_MAX_STEP) ? ratio : GOVERNOR_MAX_STEP;
+            int64_t period = governor->period * step;
+
+            governor->period = (period < governor->maxPeriod) ? period : governor->maxPeriod;
+            next = (level > GOVERNOR_REDUCED_RATE) ? level : GOVERNOR_REDUCED_RATE;
+        }
+    }
+    else if ((level > GOVERNOR_REDUCED_RATE) && (ratio < GOVERNOR_RESTORE))
+    {
+        next = shedLess(governor, level);
+    }
+    else if ((level == GOVERNOR_REDUCED_RATE) && (ratio < GOVERNOR_HEADROOM))
+    {
+        // aim for the headroom mark rather than straight at the budget
+        double step = ratio / GOVERNOR_HEADROOM;
+        int64_t period = governor->period *
+                         ((step > 1.0 / GOVERNOR_MAX_STEP) ? step : 1.0 / GOVERNOR_MAX_STEP);
+
+        governor->period = (period > governor->minPeriod) ? period : governor->minPeriod;
+        next = (governor->period == governor->minPeriod) ? GOVERNOR_FULL_RATE : level;
+    }
+
+    atomic_store(&governor->level, next);
+
+    int64_t change = governor->period - governor->reportedPeriod;
+    bool settled = (governor->period == lastPeriod) &&
+                   (llabs(change) > governor->reportedPeriod * GOVERNOR_REPORT_CHANGE);
+
+    if ((next != level) || settled)
+    {
+        governor->reportedPeriod = governor->period;
+        return true;
+    }
+
+    return false;
+}
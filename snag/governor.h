@@ -0,0 +1,98 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+//-------------------------------------------------------------------------
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Keeps snag's CPU use within a budget, e.g. 5% of one core. Every
+// GOVERNOR_WINDOW_SECONDS the CPU time of the whole process, all threads,
+// is read from CLOCK_PROCESS_CPUTIME_ID and the frame period scaled by how
+// far it is over or under the budget, between minPeriod and maxPeriod.
+//
+// Only once the frame rate is down to maxPeriod and still over budget
+// does the governor shed work, a level at a time: first the capture is
+// narrowed to recent changes, then error diffusion gives way to ordered
+// dither. Both come back, in the reverse order, once well under budget,
+// before the frame rate goes back up.
+
+#define GOVERNOR_WINDOW_SECONDS 2
+
+typedef enum
+{
+    GOVERNOR_FULL_RATE,         // within budget at minPeriod
+    GOVERNOR_REDUCED_RATE,      // a longer frame period
+    GOVERNOR_REGION,            // and the dynamic region
+    GOVERNOR_DITHER             // and ordered dither
+} GovernorLevel;
+
+typedef struct
+{
+    double budget;              // fraction of one CPU
+    int64_t minPeriod;          // nanoseconds, the --fps period
+    int64_t maxPeriod;          // the --idle-fps period
+    bool shedRegion;            // may turn on the dynamic region
+    bool shedDither;            // may replace error diffusion
+
+    // set by updateGovernor(); level is read on other threads
+    int64_t period;
+    double used;                // fraction of one CPU in the last window
+    _Atomic uint32_t level;
+
+    uint64_t windowStart;       // CLOCK_MONOTONIC, nanoseconds
+    uint64_t cpuStart;          // CLOCK_PROCESS_CPUTIME_ID
+    int64_t reportedPeriod;
+} Governor;
+
+//-------------------------------------------------------------------------
+
+// Starts at the full rate, once budget, the periods and what may be shed
+// are set.
+
+void
+initGovernor(
+    Governor *governor);
+
+// Called once a frame, on one thread. At the end of each window adjusts
+// period and level. Returns true when either is worth reporting: the
+// level changed, or the rate settled at a new value for a window.
+
+bool
+updateGovernor(
+    Governor *governor);
+
+//-------------------------------------------------------------------------
+
+#endif
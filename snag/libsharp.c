@@ -0,0 +1,380 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/spi/spidev.h>
+
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+#include "libsharp.h"
+#include "pack.h"
+
+//-------------------------------------------------------------------------
+
+#define SHARP_LINE_BYTES (SHARP_WIDTH / 8)
+
+#define SHARP_CMD_UPDATE 0x80
+#define SHARP_CMD_VCOM 0x40
+#define SHARP_CMD_CLEAR 0x20
+
+// address, data and one dummy byte per line; the command byte and a
+// trailing dummy byte per transfer
+#define SHARP_LINE_SIZE (1 + SHARP_LINE_BYTES + 1)
+
+// spidev refuses messages larger than its bufsiz module parameter, 4096
+// bytes by default
+#define SHARP_MAX_TRANSFER 4096
+#define SHARP_LINES_PER_TRANSFER ((SHARP_MAX_TRANSFER - 2) / SHARP_LINE_SIZE)
+
+#define SHARP_VCOM_PERIOD_NS 1000000000LL
+
+//-------------------------------------------------------------------------
+
+struct SharpPanel
+{
+    int fd;
+    bool isFile;
+    uint32_t speedHz;
+    uint8_t vcom;
+    int64_t vcomToggled;
+    uint8_t shadow[SHARP_HEIGHT][SHARP_LINE_BYTES];
+    uint8_t dirty[SHARP_HEIGHT];
+    uint8_t buffer[SHARP_MAX_TRANSFER];
+};
+
+//-------------------------------------------------------------------------
+
+static int64_t
+monotonicNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+//-------------------------------------------------------------------------
+
+static uint8_t
+reverseByte(
+    uint8_t b)
+{
+    b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+    b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+    b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+
+    return b;
+}
+
+//-------------------------------------------------------------------------
+
+static int
+transfer(
+    SharpPanel *panel,
+    const uint8_t *buffer,
+    uint32_t length)
+{
+    if (panel->isFile)
+    {
+        while (length > 0)
+        {
+            ssize_t written = write(panel->fd, buffer, length);
+
+            if (written == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                return -1;
+            }
+
+            buffer += written;
+            length -= written;
+        }
+
+        return 0;
+    }
+
+    struct spi_ioc_transfer xfer =
+    {
+        .tx_buf = (uintptr_t)buffer,
+        .len = length,
+        .speed_hz = panel->speedHz,
+        .bits_per_word = 8
+    };
+
+    return (ioctl(panel->fd, SPI_IOC_MESSAGE(1), &xfer) < 0) ? -1 : 0;
+}
+
+//-------------------------------------------------------------------------
+
+// Sends a two byte command (clear or VCOM only).
+
+static int
+sendCommand(
+    SharpPanel *panel,
+    uint8_t command)
+{
+    uint8_t buffer[2] = { command | panel->vcom, 0x00 };
+
+    return transfer(panel, buffer, sizeof(buffer));
+}
+
+//-------------------------------------------------------------------------
+
+// Flips VCOM once a period has passed, returns true if it did.
+
+static bool
+updateVcom(
+    SharpPanel *panel)
+{
+    int64_t now = monotonicNs();
+
+    if ((now - panel->vcomToggled) < SHARP_VCOM_PERIOD_NS)
+    {
+        return false;
+    }
+
+    panel->vcom ^= SHARP_CMD_VCOM;
+    panel->vcomToggled = now;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+// Sends every dirty line, as many lines per transfer as fit.
+
+static int
+sendDirtyLines(
+    SharpPanel *panel)
+{
+    uint8_t *buffer = panel->buffer;
+    uint32_t length = 0;
+    uint32_t lines = 0;
+    int sent = 0;
+
+    for (uint32_t y = 0; y < SHARP_HEIGHT; y++)
+    {
+        if (!panel->dirty[y])
+        {
+            continue;
+        }
+
+        panel->dirty[y] = 0;
+
+        if (lines == 0)
+        {
+            buffer[length++] = SHARP_CMD_UPDATE | panel->vcom;
+        }
+
+        buffer[length++] = reverseByte(y + 1);  // lines are numbered from 1
+        memcpy(buffer + length, panel->shadow[y], SHARP_LINE_BYTES);
+        length += SHARP_LINE_BYTES;
+        buffer[length++] = 0x00;
+
+        ++lines;
+        ++sent;
+
+        if (lines == SHARP_LINES_PER_TRANSFER)
+        {
+            buffer[length++] = 0x00;
+
+            if (transfer(panel, buffer, length) == -1)
+            {
+                return -1;
+            }
+
+            length = 0;
+            lines = 0;
+        }
+    }
+
+    if (lines > 0)
+    {
+        buffer[length++] = 0x00;
+
+        if (transfer(panel, buffer, length) == -1)
+        {
+            return -1;
+        }
+    }
+
+    return sent;
+}
+
+//-------------------------------------------------------------------------
+
+SharpPanel *
+sharpOpen(
+    const char *device,
+    uint32_t speedHz)
+{
+    SharpPanel *panel = calloc(1, sizeof(SharpPanel));
+
+    if (panel == NULL)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+
+    panel->isFile = (stat(device, &st) == -1) ? (errno == ENOENT)
+                                                : S_ISREG(st.st_mode);
+    panel->speedHz = speedHz;
+    panel->vcomToggled = monotonicNs();
+
+    if (panel->isFile)
+    {
+        panel->fd = open(device, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    else
+    {
+        panel->fd = open(device, O_RDWR);
+    }
+
+    if (panel->fd == -1)
+    {
+        free(panel);
+        return NULL;
+    }
+
+    if (!panel->isFile)
+    {
+        // the panel's chip select is active high
+        uint8_t mode = SPI_MODE_0 | SPI_CS_HIGH;
+        uint8_t bits = 8;
+
+        if ((ioctl(panel->fd, SPI_IOC_WR_MODE, &mode) == -1) ||
+            (ioctl(panel->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) == -1) ||
+            (ioctl(panel->fd, SPI_IOC_WR_MAX_SPEED_HZ, &speedHz) == -1))
+        {
+            int error = errno;
+            close(panel->fd);
+            free(panel);
+            errno = error;
+            return NULL;
+        }
+    }
+
+    if (sharpClear(panel) == -1)
+    {
+        int error = errno;
+        close(panel->fd);
+        free(panel);
+        errno = error;
+        return NULL;
+    }
+
+    return panel;
+}
+
+//-------------------------------------------------------------------------
+
+int
+sharpWriteRows(
+    SharpPanel *panel,
+    const uint8_t *pixels,
+    uint32_t pitch,
+    const uint8_t *rows)
+{
+    for (uint32_t y = 0; y < SHARP_HEIGHT; y++)
+    {
+        if ((rows != NULL) && !rows[y])
+        {
+            continue;
+        }
+
+        const uint8_t *row = pixels + y * pitch;
+        uint8_t *line = panel->shadow[y];
+
+        for (uint32_t i = 0; i < SHARP_LINE_BYTES; i++, row += 8)
+        {
+            uint8_t packed = packEight(row);
+
+            if (line[i] != packed)
+            {
+                line[i] = packed;
+                panel->dirty[y] = 1;
+            }
+        }
+    }
+
+    bool toggled = updateVcom(panel);
+    int sent = sendDirtyLines(panel);
+
+    // an idle panel still needs VCOM to alternate
+    if ((sent == 0) && toggled)
+    {
+        if (sendCommand(panel, 0x00) == -1)
+        {
+            return -1;
+        }
+    }
+
+    return sent;
+}
+
+//-------------------------------------------------------------------------
+
+int
+sharpClear(
+    SharpPanel *panel)
+{
+    // a cleared panel is white
+    memset(panel->shadow, 0xFF, sizeof(panel->shadow));
+    memset(panel->dirty, 0, sizeof(panel->dirty));
+
+    return sendCommand(panel, SHARP_CMD_CLEAR);
+}
+
+//-------------------------------------------------------------------------
+
+void
+sharpClose(
+    SharpPanel *panel)
+{
+    if (panel == NULL)
+    {
+        return;
+    }
+
+    close(panel->fd);
+    free(panel);
+}
@@ -0,0 +1,87 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef LIBSHARP_H
+#define LIBSHARP_H
+
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Drives a 400x240 Sharp memory LCD directly through spidev, without the
+// fb1 kernel driver. The panel keeps a packed 1-bit shadow of the screen;
+// each update packs the rows given to it, compares them with the shadow
+// and sends only the lines that differ, several lines per SPI transfer.
+// VCOM is toggled in-band (bit 6 of the command byte) about once a second,
+// which needs the panel's EXTMODE pin tied low.
+//
+// If the device is a regular file (or does not exist) it is truncated and
+// the transfers are written to it instead, so the output can be checked
+// without a panel.
+
+#define SHARP_WIDTH 400
+#define SHARP_HEIGHT 240
+#define SHARP_DEFAULT_SPEED_HZ 8000000
+
+typedef struct SharpPanel SharpPanel;
+
+//-------------------------------------------------------------------------
+
+// Opens the device and clears the panel. Returns NULL with errno set on
+// failure.
+
+SharpPanel *
+sharpOpen(
+    const char *device,
+    uint32_t speedHz);
+
+// Updates the panel from 8-bit pixels, any non-zero pixel is white. Only
+// the rows flagged in rows are packed, or every row if rows is NULL.
+// VCOM is only toggled from here, so call it every frame even when no row
+// changed. Returns the number of lines sent, or -1 with errno set.
+
+int
+sharpWriteRows(
+    SharpPanel *panel,
+    const uint8_t *pixels,
+    uint32_t pitch,
+    const uint8_t *rows);
+
+int
+sharpClear(
+    SharpPanel *panel);
+
+void
+sharpClose(
+    SharpPanel *panel);
+
+//-------------------------------------------------------------------------
+
+#endif
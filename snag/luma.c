@@ -0,0 +1,75 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "luma.h"
+
+//-------------------------------------------------------------------------
+
+uint8_t lumaTable[65536];
+
+//-------------------------------------------------------------------------
+
+void
+buildLumaTable(
+    double gamma,
+    double contrast)
+{
+    bool adjust = (gamma != 1.0) || (contrast != 1.0);
+
+    for (uint32_t pixel = 0; pixel < 65536; pixel++)
+    {
+        // Expand the 5-bit and 6-bit components to 8-bit values
+        uint16_t red = (pixel >> 11) & 0x1F;
+        uint16_t green = (pixel >> 5) & 0x3F;
+        uint16_t blue = pixel & 0x1F;
+
+        red = (red << 3) | (red >> 2);
+        green = (green << 2) | (green >> 4);
+        blue = (blue << 3) | (blue >> 2);
+
+        double gray = (LUMA_WEIGHT_RED * red +
+                       LUMA_WEIGHT_GREEN * green +
+                       LUMA_WEIGHT_BLUE * blue) >> 8;
+
+        if (adjust)
+        {
+            // gamma > 1 brightens the midtones, contrast stretches around mid-gray
+            gray = 255.0 * pow(gray / 255.0, 1.0 / gamma);
+            gray = (gray - 127.5) * contrast + 127.5 + 0.5;
+        }
+
+        gray = gray < 0.0 ? 0.0 : gray;
+        gray = gray > 255.0 ? 255.0 : gray;
+
+        lumaTable[pixel] = (uint8_t)gray;
+    }
+}
@@ -3,6 +3,7 @@
 // The MIT License (MIT)
 //
 // Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
 //
 // Permission is hereby granted, free of charge, to any person obtaining a
 // copy of this software and associated documentation files (the
@@ -25,35 +26,33 @@
 //
 //-------------------------------------------------------------------------
 
-#ifndef SYSLOG_UTILITIES_H
-#define SYSLOG_UTILITIES_H
+#ifndef LUMA_H
+#define LUMA_H
 
 //-------------------------------------------------------------------------
 
-#include <stdbool.h>
+#include <stdint.h>
 
-#include <bsd/libutil.h>
+//-------------------------------------------------------------------------
+
+// Integer luma weights (sum 256), shared by the table and the SIMD kernels
+// so that both give the same gray level for a pixel.
+
+#define LUMA_WEIGHT_RED 77
+#define LUMA_WEIGHT_GREEN 150
+#define LUMA_WEIGHT_BLUE 29
 
 //-------------------------------------------------------------------------
 
-void
-messageLog(
-    bool isDaemon,
-    const char *name,
-    int priority,
-    const char *format,
-    ...);
+// Gray level (0-255) of every RGB565 value, indexed by the pixel itself.
+// Built once at startup, with any gamma/contrast adjustment folded in.
 
-void
-perrorLog(
-    bool isDaemon,
-    const char *name,
-    const char *s);
+extern uint8_t lumaTable[65536];
 
 void
-exitAndRemovePidFile(
-    int status,
-    struct pidfh *pfh);
+buildLumaTable(
+    double gamma,
+    double contrast);
 
 //-------------------------------------------------------------------------
 
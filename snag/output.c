@@ -0,0 +1,72 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <string.h>
+
+#include "output.h"
+
+//-------------------------------------------------------------------------
+
+Output *
+openOutput(
+    const char *spec,
+    const char *fbDevice,
+    const char **error)
+{
+    if (strcmp(spec, "fb") == 0)
+    {
+        return openFbOutput(fbDevice, error);
+    }
+
+    if (strncmp(spec, "fb:", 3) == 0)
+    {
+        return openFbOutput(spec + 3, error);
+    }
+
+    if (strncmp(spec, "spidev:", 7) == 0)
+    {
+        return openSpidevOutput(spec + 7, error);
+    }
+
+    *error = "unknown output";
+    errno = EINVAL;
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+void
+closeOutput(
+    Output *output)
+{
+    if (output != NULL)
+    {
+        output->close(output);
+    }
+}
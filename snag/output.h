@@ -0,0 +1,103 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Where converted frames go. The converter writes one byte per pixel
+// (non-zero is white) into pixels; flush() then puts the rows flagged in
+// changedRows on the panel and clears the flags.
+//
+//     fb[:<device>]         a framebuffer (default /dev/fb1): 8 bits per
+//                           pixel are written in place, 1 bit per pixel
+//                           framebuffers get the changed rows packed
+//     spidev:<device>       the panel itself through spidev (libsharp.h)
+
+typedef struct Output Output;
+
+struct Output
+{
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;             // bytes per row of pixels
+    uint8_t *pixels;
+    uint8_t *changedRows;       // NULL if flush() does not use them
+
+    bool
+    (*flush)(
+        Output *output);
+
+    void
+    (*close)(
+        Output *output);
+
+    void *state;
+};
+
+//-------------------------------------------------------------------------
+
+// Opens the backend named by spec, fbDevice is used for a bare "fb".
+// Returns NULL with errno set and a reason in *error on failure.
+
+Output *
+openOutput(
+    const char *spec,
+    const char *fbDevice,
+    const char **error);
+
+// Blanks the panel and closes the output.
+
+void
+closeOutput(
+    Output *output);
+
+//-------------------------------------------------------------------------
+
+// The backends, for openOutput()
+
+Output *
+openFbOutput(
+    const char *device,
+    const char **error);
+
+Output *
+openSpidevOutput(
+    const char *device,
+    const char **error);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,227 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/fb.h>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include "output.h"
+#include "pack.h"
+
+//-------------------------------------------------------------------------
+
+// The sharp driver's 8 bits per pixel framebuffer is written in place by
+// the converter. Framebuffers with 1 bit per pixel get each changed row
+// packed 8 pixels to a byte, first pixel in the most significant bit.
+
+typedef struct
+{
+    int fd;
+    uint8_t *map;
+    size_t mapSize;
+    uint32_t lineLength;
+    bool invert;                // FB_VISUAL_MONO01: a set bit is black
+} FbState;
+
+//-------------------------------------------------------------------------
+
+static bool
+flushFb(
+    Output *output)
+{
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+flushPackedFb(
+    Output *output)
+{
+    FbState *state = output->state;
+    uint8_t invert = state->invert ? 0xFF : 0x00;
+    uint32_t bytes = (output->width + 7) / 8;
+
+    for (uint32_t y = 0; y < output->height; y++)
+    {
+        if (!output->changedRows[y])
+        {
+            continue;
+        }
+
+        const uint8_t *row = output->pixels + y * output->pitch;
+        uint8_t *line = state->map + y * state->lineLength;
+
+        for (uint32_t i = 0; i < bytes; i++, row += 8)
+        {
+            line[i] = packEight(row) ^ invert;
+        }
+
+        output->changedRows[y] = 0;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+closeFb(
+    Output *output)
+{
+    FbState *state = output->state;
+    int error = errno;  // for the error paths of openFbOutput()
+
+    if (state->map != NULL)
+    {
+        memset(state->map, 0, state->mapSize);
+        munmap(state->map, state->mapSize);
+    }
+
+    if (output->pixels != state->map)
+    {
+        free(output->pixels);
+    }
+
+    free(output->changedRows);
+    close(state->fd);
+    free(state);
+    free(output);
+    errno = error;
+}
+
+//-------------------------------------------------------------------------
+
+Output *
+openFbOutput(
+    const char *device,
+    const char **error)
+{
+    Output *output = calloc(1, sizeof(Output));
+    FbState *state = calloc(1, sizeof(FbState));
+
+    if ((output == NULL) || (state == NULL))
+    {
+        free(output);
+        free(state);
+        *error = "cannot allocate framebuffer output";
+        return NULL;
+    }
+
+    state->fd = open(device, O_RDWR);
+
+    if (state->fd == -1)
+    {
+        free(output);
+        free(state);
+        *error = "cannot open framebuffer device";
+        return NULL;
+    }
+
+    output->name = "fb";
+    output->flush = flushFb;
+    output->close = closeFb;
+    output->state = state;
+
+    struct fb_fix_screeninfo finfo;
+    struct fb_var_screeninfo vinfo;
+
+    if (ioctl(state->fd, FBIOGET_FSCREENINFO, &finfo) == -1)
+    {
+        closeFb(output);
+        *error = "cannot get framebuffer fixed information";
+        return NULL;
+    }
+
+    if (ioctl(state->fd, FBIOGET_VSCREENINFO, &vinfo) == -1)
+    {
+        closeFb(output);
+        *error = "cannot get framebuffer variable information";
+        return NULL;
+    }
+
+    if ((vinfo.bits_per_pixel != 8) && (vinfo.bits_per_pixel != 1))
+    {
+        errno = ENOTSUP;
+        closeFb(output);
+        *error = "framebuffer must have 8 or 1 bits per pixel";
+        return NULL;
+    }
+
+    output->width = vinfo.xres;
+    output->height = vinfo.yres;
+    state->lineLength = finfo.line_length;
+    state->mapSize = (size_t)finfo.line_length * vinfo.yres;
+    state->invert = finfo.visual == FB_VISUAL_MONO01;
+    state->map = mmap(NULL,
+                      state->mapSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED,
+                      state->fd,
+                      0);
+
+    if (state->map == MAP_FAILED)
+    {
+        state->map = NULL;
+        closeFb(output);
+        *error = "cannot map framebuffer into memory";
+        return NULL;
+    }
+
+    memset(state->map, 0, state->mapSize);
+
+    if (vinfo.bits_per_pixel == 8)
+    {
+        output->pixels = state->map;
+        output->pitch = state->lineLength;
+        return output;
+    }
+
+    // whole bytes per packed row
+    output->name = "fb packed";
+    output->flush = flushPackedFb;
+    output->pitch = (output->width + 7) & ~7;
+    output->pixels = calloc(output->pitch * output->height, 1);
+    output->changedRows = calloc(output->height, 1);
+
+    if ((output->pixels == NULL) || (output->changedRows == NULL))
+    {
+        closeFb(output);
+        *error = "cannot allocate framebuffer output";
+        return NULL;
+    }
+
+    return output;
+}
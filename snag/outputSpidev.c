@@ -0,0 +1,118 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libsharp.h"
+#include "output.h"
+
+//-------------------------------------------------------------------------
+
+// Drives the panel directly with libsharp, without the fb1 driver.
+
+static bool
+flushSpidev(
+    Output *output)
+{
+    SharpPanel *panel = output->state;
+
+    if (sharpWriteRows(panel, output->pixels, output->pitch, output->changedRows) == -1)
+    {
+        return false;
+    }
+
+    memset(output->changedRows, 0, output->height);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+closeSpidev(
+    Output *output)
+{
+    SharpPanel *panel = output->state;
+
+    if (panel != NULL)
+    {
+        sharpClear(panel);
+        sharpClose(panel);
+    }
+
+    free(output->changedRows);
+    free(output->pixels);
+    free(output);
+}
+
+//-------------------------------------------------------------------------
+
+Output *
+openSpidevOutput(
+    const char *device,
+    const char **error)
+{
+    Output *output = calloc(1, sizeof(Output));
+
+    if (output == NULL)
+    {
+        *error = "cannot allocate spidev output";
+        return NULL;
+    }
+
+    output->name = "spidev";
+    output->width = SHARP_WIDTH;
+    output->height = SHARP_HEIGHT;
+    output->pitch = SHARP_WIDTH;
+    output->flush = flushSpidev;
+    output->close = closeSpidev;
+    output->pixels = calloc(SHARP_WIDTH * SHARP_HEIGHT, 1);
+    output->changedRows = calloc(SHARP_HEIGHT, 1);
+
+    if ((output->pixels == NULL) || (output->changedRows == NULL))
+    {
+        closeSpidev(output);
+        *error = "cannot allocate panel buffers";
+        return NULL;
+    }
+
+    output->state = sharpOpen(device, SHARP_DEFAULT_SPEED_HZ);
+
+    if (output->state == NULL)
+    {
+        int saved = errno;
+        closeSpidev(output);
+        errno = saved;
+        *error = "cannot open spidev device";
+        return NULL;
+    }
+
+    return output;
+}
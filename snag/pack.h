@@ -0,0 +1,72 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef PACK_H
+#define PACK_H
+
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------
+
+// Packs 8 pixels (one byte each, any non-zero pixel is set) into one
+// byte, first pixel in the most significant bit.
+
+static inline uint8_t
+packEight(
+    const uint8_t *pixels)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, pixels, sizeof(v));
+
+    // fold each byte onto its low bit, then gather the low bits into the
+    // top byte with a single multiply
+    v |= v >> 4;
+    v |= v >> 2;
+    v |= v >> 1;
+    v &= 0x0101010101010101ULL;
+
+    return (v * 0x8040201008040201ULL) >> 56;
+#else
+    uint8_t b = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        b = (b << 1) | (pixels[i] != 0);
+    }
+
+    return b;
+#endif
+}
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,1017 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pipeline.h"
+#include "tripleBuffer.h"
+
+//-------------------------------------------------------------------------
+
+#define NANOSECONDS_PER_SECOND 1000000000L
+
+// how long after a frame's deadline the capture waits for a vertical
+// blank, a little over one refresh at 50Hz
+#define VSYNC_WAIT_NANOSECONDS 25000000L
+
+#define ALIGN_TO_16(x)  ((x + 15) & ~15)
+
+// with a dynamic region: how often the whole frame is captured, how many
+// frames a change keeps its area in the window, and the margin around it
+#define REGION_FULL_FRAMES 8
+#define REGION_HOLD_FRAMES 30
+#define REGION_MARGIN 8
+
+//-------------------------------------------------------------------------
+
+// A captured frame, panel sized, handed from capture to convert.
+
+typedef struct
+{
+    uint16_t *pixels;
+    uint64_t captured;          // statsClock() as the grab started
+    uint32_t firstRow;          // panel rows that may differ from the last
+    uint32_t lastRow;           // frame convert took
+} Frame;
+
+// A converted image handed from convert to output. The versions let the
+// output copy only the rows that changed since the image it last took,
+// however many images were dropped in between.
+
+typedef struct
+{
+    uint8_t *pixels;            // output pitch
+    uint64_t *rowVersions;      // version each row last changed in
+    uint64_t version;           // of the newest frame converted into it
+    uint64_t captured;
+} Image;
+
+typedef struct
+{
+    Pipeline *pipeline;
+    uint32_t sourcePitch;
+    uint16_t *source;           // capture sized frame when scaling
+    struct timespec deadline;
+    _Atomic uint32_t unchangedFrames;
+    uint64_t statsDue;
+    pthread_mutex_t errorLock;
+
+    // dynamic region: changes found by convert since the last grab, and
+    // those of the last frames
+    pthread_mutex_t changesLock;
+    CaptureRect changes;
+    CaptureRect recentChanges[REGION_HOLD_FRAMES];
+    uint32_t recentIndex;
+    uint32_t framesToFull;
+
+    // the converter's own dither, while the governor sheds it
+    Diffuser *diffuser;
+    DitherRowKernel ditherRow;
+    bool orderedDither;
+
+    // threaded only
+    Frame frames[3];
+    Image images[3];
+    TripleBuffer captured;      // capture to convert
+    TripleBuffer converted;     // convert to output
+    atomic_bool stopping;       // the output failed
+    uint16_t *previous;         // convert's copy of the last frame
+    uint8_t *image;             // convert's copy of the panel
+    uint8_t *changedRows;
+    uint64_t *rowVersions;
+} PipelineState;
+
+//-------------------------------------------------------------------------
+
+static void
+addNanoseconds(
+    struct timespec *time,
+    int64_t nanoseconds)
+{
+    int64_t total = time->tv_nsec + nanoseconds;
+
+    time->tv_sec += total / NANOSECONDS_PER_SECOND;
+    time->tv_nsec = total % NANOSECONDS_PER_SECOND;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+isBefore(
+    const struct timespec *a,
+    const struct timespec *b)
+{
+    return (a->tv_sec < b->tv_sec) ||
+           ((a->tv_sec == b->tv_sec) && (a->tv_nsec < b->tv_nsec));
+}
+
+//-------------------------------------------------------------------------
+
+// Records the time since *clock under stat, if stats are on, and moves
+// *clock on to now as the start of the next stage.
+
+static void
+recordStage(
+    Stats *stats,
+    Stat stat,
+    uint64_t *clock)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    uint64_t now = statsClock();
+    recordStat(stats, stat, now - *clock);
+
+    *clock = now;
+}
+
+//-------------------------------------------------------------------------
+
+static uint64_t
+startClock(
+    const PipelineState *state)
+{
+    return (state->pipeline->stats != NULL) ? statsClock() : 0;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+isEmpty(
+    const CaptureRect *rect)
+{
+    return (rect->width == 0) || (rect->height == 0);
+}
+
+//-------------------------------------------------------------------------
+
+static CaptureRect
+unionRect(
+    const CaptureRect *a,
+    const CaptureRect *b)
+{
+    if (isEmpty(a))
+    {
+        return *b;
+    }
+
+    if (isEmpty(b))
+    {
+        return *a;
+    }
+
+    uint32_t x0 = (a->x < b->x) ? a->x : b->x;
+    uint32_t y0 = (a->y < b->y) ? a->y : b->y;
+    uint32_t x1 = (a->x + a->width > b->x + b->width) ? a->x + a->width : b->x + b->width;
+    uint32_t y1 = (a->y + a->height > b->y + b->height) ? a->y + a->height : b->y + b->height;
+
+    return (CaptureRect){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+//-------------------------------------------------------------------------
+
+// Whether the window may be narrowed at all. A governor may turn the
+// region on at any frame, so changes are then always tracked.
+
+static bool
+mayNarrow(
+    const Pipeline *pipeline)
+{
+    return pipeline->dynamicRegion || (pipeline->governor != NULL);
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+useRegion(
+    const PipelineState *state)
+{
+    const Pipeline *pipeline = state->pipeline;
+
+    return pipeline->dynamicRegion ||
+           ((pipeline->governor != NULL) &&
+            (atomic_load(&pipeline->governor->level) >= GOVERNOR_REGION));
+}
+
+//-------------------------------------------------------------------------
+
+// Narrows the capture window to the recent changes, plus a margin, or
+// widens it to the whole frame every REGION_FULL_FRAMES frames, and for
+// every frame while the region is off.
+
+static void
+chooseWindow(
+    PipelineState *state)
+{
+    Capture *capture = state->pipeline->capture;
+
+    pthread_mutex_lock(&state->changesLock);
+    CaptureRect changes = state->changes;
+    state->changes = (CaptureRect){ 0, 0, 0, 0 };
+    pthread_mutex_unlock(&state->changesLock);
+
+    state->recentChanges[state->recentIndex] = changes;
+    state->recentIndex = (state->recentIndex + 1) % REGION_HOLD_FRAMES;
+
+    if ((state->framesToFull == 0) || !useRegion(state))
+    {
+        capture->window = (CaptureRect){ 0, 0, capture->width, capture->height };
+        state->framesToFull = REGION_FULL_FRAMES;
+        return;
+    }
+
+    --state->framesToFull;
+
+    CaptureRect window = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < REGION_HOLD_FRAMES; i++)
+    {
+        window = unionRect(&window, &state->recentChanges[i]);
+    }
+
+    if (!isEmpty(&window))
+    {
+        uint32_t x0 = (window.x > REGION_MARGIN) ? window.x - REGION_MARGIN : 0;
+        uint32_t y0 = (window.y > REGION_MARGIN) ? window.y - REGION_MARGIN : 0;
+        uint32_t x1 = window.x + window.width + REGION_MARGIN;
+        uint32_t y1 = window.y + window.height + REGION_MARGIN;
+
+        x1 = (x1 < capture->width) ? x1 : capture->width;
+        y1 = (y1 < capture->height) ? y1 : capture->height;
+
+        window = (CaptureRect){ x0, y0, x1 - x0, y1 - y0 };
+    }
+
+    capture->window = window;
+}
+
+//-------------------------------------------------------------------------
+
+// The panel rows covered by what the last grab changed, at most the
+// capture window, with a row to spare for the scaler's rounding.
+
+static void
+windowRows(
+    const PipelineState *state,
+    uint32_t *firstRow,
+    uint32_t *lastRow)
+{
+    const Capture *capture = state->pipeline->capture;
+    const CaptureRect *window = &capture->changed;
+    uint32_t height = state->pipeline->converter->height;
+
+    if (isEmpty(window))
+    {
+        *firstRow = height;
+        *lastRow = 0;
+        return;
+    }
+
+    uint64_t first = (uint64_t)window->y * height / capture->height;
+    uint64_t last = ((uint64_t)(window->y + window->height) * height +
+                     capture->height - 1) / capture->height;
+
+    *firstRow = (first > 0) ? first - 1 : 0;
+    *lastRow = (last < height) ? last + 1 : height;
+}
+
+//-------------------------------------------------------------------------
+
+// Adds the bounding box of the spans convert found changed, in capture
+// pixels, to the changes the next window is chosen from.
+
+static void
+reportChanges(
+    PipelineState *state)
+{
+    const Converter *converter = state->pipeline->converter;
+    const Capture *capture = state->pipeline->capture;
+    uint32_t x0 = converter->width;
+    uint32_t x1 = 0;
+    uint32_t y0 = converter->height;
+    uint32_t y1 = 0;
+
+    for (uint32_t y = 0; y < converter->height; y++)
+    {
+        const uint32_t *span = converter->spans + 2 * y;
+
+        if (span[0] < span[1])
+        {
+            x0 = (span[0] < x0) ? span[0] : x0;
+            x1 = (span[1] > x1) ? span[1] : x1;
+            y0 = (y < y0) ? y : y0;
+            y1 = y + 1;
+        }
+    }
+
+    if (y1 == 0)
+    {
+        return;
+    }
+
+    uint32_t left = (uint64_t)x0 * capture->width / converter->width;
+    uint32_t top = (uint64_t)y0 * capture->height / converter->height;
+    uint32_t right = ((uint64_t)x1 * capture->width + converter->width - 1) / converter->width;
+    uint32_t bottom = ((uint64_t)y1 * capture->height + converter->height - 1) / converter->height;
+    CaptureRect rect = { left, top, right - left, bottom - top };
+
+    pthread_mutex_lock(&state->changesLock);
+    state->changes = unionRect(&state->changes, &rect);
+    pthread_mutex_unlock(&state->changesLock);
+}
+
+//-------------------------------------------------------------------------
+
+// Keeps the first error, with errno, of whichever stage fails first.
+
+static void
+fail(
+    PipelineState *state,
+    const char *error)
+{
+    int errorNumber = errno;
+
+    pthread_mutex_lock(&state->errorLock);
+
+    if (state->pipeline->error == NULL)
+    {
+        state->pipeline->error = error;
+        state->pipeline->errorNumber = errorNumber;
+    }
+
+    pthread_mutex_unlock(&state->errorLock);
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+keepRunning(
+    PipelineState *state)
+{
+    return *state->pipeline->run && !atomic_load(&state->stopping);
+}
+
+//-------------------------------------------------------------------------
+
+static void
+waitForVsync(
+    PipelineState *state)
+{
+    Capture *capture = state->pipeline->capture;
+
+    if (state->pipeline->vsync && (capture->waitVsync != NULL))
+    {
+        struct timespec limit = state->deadline;
+        addNanoseconds(&limit, VSYNC_WAIT_NANOSECONDS);
+        capture->waitVsync(capture, &limit);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Frames are due on absolute deadlines so sleeps do not add up. While
+// nothing changes they back off to the idle rate, the first change
+// restores the full rate.
+
+static void
+waitForNextFrame(
+    PipelineState *state)
+{
+    Pipeline *pipeline = state->pipeline;
+    uint32_t unchangedFrames = atomic_load(&state->unchangedFrames);
+    int64_t period = pipeline->framePeriod;
+
+    if (pipeline->governor != NULL)
+    {
+        if (updateGovernor(pipeline->governor) && (pipeline->governorChanged != NULL))
+        {
+            pipeline->governorChanged(pipeline->governor);
+        }
+
+        period = pipeline->governor->period;
+    }
+
+    bool idle = (pipeline->idleFrames > 0) &&
+                (unchangedFrames >= pipeline->idleFrames);
+
+    if (idle && (pipeline->idlePeriod > period))
+    {
+        period = pipeline->idlePeriod;
+    }
+
+    addNanoseconds(&state->deadline, period);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (isBefore(&state->deadline, &now))
+    {
+        // running late: start the next frame now rather than catch up
+        state->deadline = now;
+        return;
+    }
+
+    while ((clock_nanosleep(CLOCK_MONOTONIC,
+                            TIMER_ABSTIME,
+                            &state->deadline,
+                            NULL) == EINTR) && keepRunning(state))
+    {
+        // woken by a signal that does not stop snag
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Grabs a frame into pixels, scaled if needed. prev is the last frame
+// grabbed (it may be pixels itself).
+
+static bool
+grabFrame(
+    PipelineState *state,
+    uint16_t *pixels,
+    const uint16_t *prev,
+    uint64_t *clock)
+{
+    Pipeline *pipeline = state->pipeline;
+    Capture *capture = pipeline->capture;
+    uint32_t pitch = pipeline->converter->srcPitch;
+
+    capture->changed = capture->window;
+
+    bool grabbed = (pipeline->scaler != NULL)
+                 ? capture->grab(capture, state->source, state->source, state->sourcePitch)
+                 : capture->grab(capture, pixels, prev, pitch);
+
+    if (!grabbed)
+    {
+        fail(state, (errno == 0) ? "end of input" : "cannot capture a frame");
+        return false;
+    }
+
+    recordStage(pipeline->stats, STAT_CAPTURE, clock);
+
+    if (pipeline->scaler != NULL)
+    {
+        limitScaleRows(pipeline->scaler,
+                       capture->changed.y,
+                       capture->changed.y + capture->changed.height);
+        scaleFrame(pipeline->scaler,
+                   state->source,
+                   state->sourcePitch,
+                   pixels,
+                   prev,
+                   pitch);
+        recordStage(pipeline->stats, STAT_SCALE, clock);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+// Swaps error diffusion for ordered dither while the governor sheds it,
+// and back. Every row is converted again so the two never mix.
+
+static void
+followGovernor(
+    PipelineState *state)
+{
+    Pipeline *pipeline = state->pipeline;
+    Converter *converter = pipeline->converter;
+
+    if ((pipeline->governor == NULL) || (pipeline->orderedDither == NULL))
+    {
+        return;
+    }
+
+    bool ordered = (atomic_load(&pipeline->governor->level) >= GOVERNOR_DITHER);
+
+    if (ordered != state->orderedDither)
+    {
+        state->orderedDither = ordered;
+        converter->diffuser = ordered ? NULL : state->diffuser;
+        converter->ditherRow = ordered ? pipeline->orderedDither : state->ditherRow;
+        converter->convertAll = true;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Converts the rows that changed since the last frame, in two passes
+// when each is timed, and counts unchanged frames for the idle rate.
+
+static void
+convertPixels(
+    PipelineState *state,
+    const uint16_t *newPixels,
+    const uint16_t *oldPixels,
+    uint8_t *output,
+    uint64_t *clock)
+{
+    Converter *converter = state->pipeline->converter;
+    Stats *stats = state->pipeline->stats;
+    uint32_t changed;
+
+    followGovernor(state);
+
+    if (stats != NULL)
+    {
+        changed = diffFrame(converter, newPixels, oldPixels);
+        recordStage(stats, STAT_DIFF, clock);
+        ditherFrame(converter, output);
+        recordStage(stats, STAT_CONVERT, clock);
+
+        recordStat(stats, STAT_CHANGED_ROWS, changed);
+        recordStat(stats, STAT_CHANGED_PIXELS, changedPixels(converter));
+    }
+    else
+    {
+        changed = convertFrame(converter, newPixels, oldPixels, output);
+    }
+
+    uint32_t unchangedFrames = atomic_load(&state->unchangedFrames);
+    atomic_store(&state->unchangedFrames, (changed == 0) ? unchangedFrames + 1 : 0);
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+flushOutput(
+    PipelineState *state,
+    uint64_t *clock,
+    uint64_t captured)
+{
+    Pipeline *pipeline = state->pipeline;
+
+    if (!pipeline->output->flush(pipeline->output))
+    {
+        fail(state, "cannot write to the display");
+        return false;
+    }
+
+    if (pipeline->stats != NULL)
+    {
+        recordStage(pipeline->stats, STAT_WRITE, clock);
+        recordStat(pipeline->stats, STAT_FRAME, *clock - captured);
+
+        if (*clock >= state->statsDue)
+        {
+            if (!writeStats(pipeline->stats) && (pipeline->statsError != NULL))
+            {
+                pipeline->statsError();
+            }
+
+            state->statsDue = *clock + pipeline->statsInterval;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+runSequential(
+    PipelineState *state)
+{
+    Pipeline *pipeline = state->pipeline;
+    Converter *converter = pipeline->converter;
+    Output *output = pipeline->output;
+    size_t size = converter->srcPitch * converter->height * sizeof(uint16_t);
+
+    uint16_t *newPixels = malloc(size);
+    uint16_t *oldPixels = malloc(size);
+
+    if ((newPixels == NULL) || (oldPixels == NULL))
+    {
+        fail(state, "cannot allocate offscreen buffers");
+        free(newPixels);
+        free(oldPixels);
+        return;
+    }
+
+    memset(oldPixels, 1, size);
+    converter->changedRows = output->changedRows;
+
+    while (*pipeline->run)
+    {
+        waitForVsync(state);
+
+        if (mayNarrow(pipeline))
+        {
+            chooseWindow(state);
+        }
+
+        uint64_t clock = startClock(state);
+        uint64_t captured = clock;
+
+        if (!grabFrame(state, newPixels, oldPixels, &clock))
+        {
+            break;
+        }
+
+        windowRows(state, &converter->firstRow, &converter->lastRow);
+        convertPixels(state, newPixels, oldPixels, output->pixels, &clock);
+
+        if (mayNarrow(pipeline))
+        {
+            reportChanges(state);
+        }
+
+        if (!flushOutput(state, &clock, captured))
+        {
+            break;
+        }
+
+        uint16_t *pixels = oldPixels;
+        oldPixels = newPixels;
+        newPixels = pixels;
+
+        if (pipeline->once)
+        {
+            break;
+        }
+
+        waitForNextFrame(state);
+    }
+
+    free(newPixels);
+    free(oldPixels);
+}
+
+//-------------------------------------------------------------------------
+
+// Sets the pace, and grabs into the back frame. The previous frame is
+// the last one published: convert may be reading it, but only reads.
+//
+// Rows outside the window are those of the last frame published, which
+// convert may have dropped. A frame's rows therefore take in those of
+// the frame before it, unless that one was taken.
+
+static void *
+captureStage(
+    void *arg)
+{
+    PipelineState *state = arg;
+    uint32_t height = state->pipeline->converter->height;
+    const uint16_t *prev = NULL;
+    uint32_t carriedFirst = height;
+    uint32_t carriedLast = 0;
+
+    while (keepRunning(state))
+    {
+        if (mayNarrow(state->pipeline))
+        {
+            chooseWindow(state);
+        }
+
+        waitForVsync(state);
+
+        Frame *frame = tripleBufferBack(&state->captured);
+        uint64_t clock = startClock(state);
+        frame->captured = clock;
+
+        if (!grabFrame(state, frame->pixels, (prev != NULL) ? prev : frame->pixels, &clock))
+        {
+            break;
+        }
+
+        uint32_t firstRow;
+        uint32_t lastRow;
+        windowRows(state, &firstRow, &lastRow);
+
+        frame->firstRow = (firstRow < carriedFirst) ? firstRow : carriedFirst;
+        frame->lastRow = (lastRow > carriedLast) ? lastRow : carriedLast;
+
+        bool dropped = publishTripleBuffer(&state->captured);
+        prev = frame->pixels;
+
+        carriedFirst = dropped ? frame->firstRow : firstRow;
+        carriedLast = dropped ? frame->lastRow : lastRow;
+
+        waitForNextFrame(state);
+    }
+
+    closeTripleBuffer(&state->captured);
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+// Converts each frame it takes into a private image of the panel, which
+// stays whole across dropped frames, then copies the rows newer than the
+// back image's into it and publishes it. An image goes out every frame,
+// changed or not, so the output flushes as often as without the pipeline;
+// a static panel still needs VCOM alternated (sharpWriteRows()).
+
+static void *
+convertStage(
+    void *arg)
+{
+    PipelineState *state = arg;
+    Converter *converter = state->pipeline->converter;
+    uint32_t height = converter->height;
+    size_t frameRow = converter->srcPitch * sizeof(uint16_t);
+    size_t imageRow = state->pipeline->output->pitch;
+    uint64_t version = 0;
+    Frame *frame;
+
+    while ((frame = waitTripleBuffer(&state->captured)) != NULL)
+    {
+        uint64_t clock = startClock(state);
+        converter->firstRow = frame->firstRow;
+        converter->lastRow = frame->lastRow;
+        convertPixels(state, frame->pixels, state->previous, state->image, &clock);
+
+        if (mayNarrow(state->pipeline))
+        {
+            reportChanges(state);
+        }
+
+        // the next frame is diffed against this one; rows with unchanged
+        // hashes already match
+        ++version;
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            if (converter->dirtyRows[y])
+            {
+                memcpy(state->previous + y * converter->srcPitch,
+                       frame->pixels + y * converter->srcPitch,
+                       frameRow);
+            }
+
+            if (state->changedRows[y])
+            {
+                state->rowVersions[y] = version;
+                state->changedRows[y] = 0;
+            }
+        }
+
+        Image *image = tripleBufferBack(&state->converted);
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            if (state->rowVersions[y] > image->version)
+            {
+                memcpy(image->pixels + y * imageRow,
+                       state->image + y * imageRow,
+                       imageRow);
+            }
+        }
+
+        memcpy(image->rowVersions, state->rowVersions, height * sizeof(uint64_t));
+        image->version = version;
+        image->captured = frame->captured;
+
+        publishTripleBuffer(&state->converted);
+    }
+
+    closeTripleBuffer(&state->converted);
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+// Copies the rows that changed since the last image flushed to the
+// output, and flushes them.
+
+static void
+outputStage(
+    PipelineState *state)
+{
+    Output *output = state->pipeline->output;
+    uint64_t flushed = 0;
+    Image *image;
+
+    while ((image = waitTripleBuffer(&state->converted)) != NULL)
+    {
+        uint64_t clock = startClock(state);
+
+        for (uint32_t y = 0; y < output->height; y++)
+        {
+            if (image->rowVersions[y] > flushed)
+            {
+                memcpy(output->pixels + y * output->pitch,
+                       image->pixels + y * output->pitch,
+                       output->pitch);
+
+                if (output->changedRows != NULL)
+                {
+                    output->changedRows[y] = 1;
+                }
+            }
+        }
+
+        flushed = image->version;
+
+        if (!flushOutput(state, &clock, image->captured))
+        {
+            // capture stops, and convert after it
+            atomic_store(&state->stopping, true);
+            break;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+freeThreadedBuffers(
+    PipelineState *state)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        free(state->frames[i].pixels);
+        free(state->images[i].pixels);
+        free(state->images[i].rowVersions);
+    }
+
+    free(state->previous);
+    free(state->image);
+    free(state->changedRows);
+    free(state->rowVersions);
+}
+
+//-------------------------------------------------------------------------
+
+static void
+runThreaded(
+    PipelineState *state)
+{
+    Converter *converter = state->pipeline->converter;
+    uint32_t height = converter->height;
+    size_t frameSize = converter->srcPitch * height * sizeof(uint16_t);
+    size_t imageSize = state->pipeline->output->pitch * height;
+    bool allocated = true;
+
+    for (int i = 0; i < 3; i++)
+    {
+        state->frames[i].pixels = malloc(frameSize);
+        state->images[i].pixels = calloc(imageSize, 1);
+        state->images[i].rowVersions = calloc(height, sizeof(uint64_t));
+
+        allocated = allocated &&
+                    (state->frames[i].pixels != NULL) &&
+                    (state->images[i].pixels != NULL) &&
+                    (state->images[i].rowVersions != NULL);
+    }
+
+    state->previous = malloc(frameSize);
+    state->image = calloc(imageSize, 1);
+    state->changedRows = calloc(height, 1);
+    state->rowVersions = calloc(height, sizeof(uint64_t));
+
+    if (!allocated ||
+        (state->previous == NULL) ||
+        (state->image == NULL) ||
+        (state->changedRows == NULL) ||
+        (state->rowVersions == NULL))
+    {
+        fail(state, "cannot allocate pipeline buffers");
+        freeThreadedBuffers(state);
+        return;
+    }
+
+    memset(state->previous, 1, frameSize);
+    converter->changedRows = state->changedRows;
+
+    initTripleBuffer(&state->captured,
+                     &state->frames[0],
+                     &state->frames[1],
+                     &state->frames[2]);
+    initTripleBuffer(&state->converted,
+                     &state->images[0],
+                     &state->images[1],
+                     &state->images[2]);
+
+    pthread_t convertThread;
+    pthread_t captureThread;
+    int result = pthread_create(&convertThread, NULL, convertStage, state);
+
+    if (result != 0)
+    {
+        errno = result;
+        fail(state, "cannot start the convert thread");
+        freeThreadedBuffers(state);
+        return;
+    }
+
+    result = pthread_create(&captureThread, NULL, captureStage, state);
+
+    if (result != 0)
+    {
+        errno = result;
+        fail(state, "cannot start the capture thread");
+        closeTripleBuffer(&state->captured);
+        pthread_join(convertThread, NULL);
+        freeThreadedBuffers(state);
+        return;
+    }
+
+    outputStage(state);
+
+    pthread_join(captureThread, NULL);
+    pthread_join(convertThread, NULL);
+
+    freeThreadedBuffers(state);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+runPipeline(
+    Pipeline *pipeline)
+{
+    PipelineState state;
+    memset(&state, 0, sizeof(state));
+
+    state.pipeline = pipeline;
+    state.diffuser = pipeline->converter->diffuser;
+    state.ditherRow = pipeline->converter->ditherRow;
+    atomic_init(&state.unchangedFrames, 0);
+    atomic_init(&state.stopping, false);
+    pthread_mutex_init(&state.errorLock, NULL);
+    pthread_mutex_init(&state.changesLock, NULL);
+
+    pipeline->error = NULL;
+    pipeline->errorNumber = 0;
+
+    if (pipeline->scaler != NULL)
+    {
+        Capture *capture = pipeline->capture;
+
+        state.sourcePitch = ALIGN_TO_16(capture->width);
+        state.source = malloc(state.sourcePitch * capture->height * sizeof(uint16_t));
+
+        if (state.source == NULL)
+        {
+            fail(&state, "cannot allocate scaling buffers");
+            pthread_mutex_destroy(&state.errorLock);
+            pthread_mutex_destroy(&state.changesLock);
+            return false;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &state.deadline);
+
+    if (pipeline->stats != NULL)
+    {
+        state.statsDue = statsClock() + pipeline->statsInterval;
+    }
+
+    if (pipeline->threaded && !pipeline->once)
+    {
+        runThreaded(&state);
+    }
+    else
+    {
+        runSequential(&state);
+    }
+
+    // the converter owns its diffuser again, to free it
+    pipeline->converter->diffuser = state.diffuser;
+    pipeline->converter->ditherRow = state.ditherRow;
+
+    free(state.source);
+    pthread_mutex_destroy(&state.errorLock);
+    pthread_mutex_destroy(&state.changesLock);
+
+    return (pipeline->error == NULL);
+}
@@ -0,0 +1,111 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "capture.h"
+#include "convert.h"
+#include "governor.h"
+#include "output.h"
+#include "scale.h"
+#include "stats.h"
+
+//-------------------------------------------------------------------------
+
+// The frame loop: capture (and scale), convert, output.
+//
+// Sequentially each frame goes through every stage before the next is
+// captured. Threaded, capture and convert run on threads of their own and
+// output on the calling thread, each stage handing its newest frame to the
+// next through a triple buffer. A stage never waits for a slower one
+// downstream: frames it produces faster than they are taken are dropped,
+// so throughput is that of the slowest stage and a displayed frame is at
+// most one frame behind at each hand off.
+//
+// Capture sets the pace in both modes: frames are due on absolute
+// deadlines, after a vertical blank if the capture has one, and come
+// idlePeriod apart once idleFrames in a row were unchanged.
+//
+// With dynamicRegion the capture window is narrowed to the bounding box
+// of the changes of the last second or so, and only the panel rows it
+// covers are converted. Every few frames the whole frame is captured, to
+// see changes anywhere else.
+//
+// With a governor the frame period is the governor's, and the dynamic
+// region and orderedDither stand in for what it sheds.
+
+typedef struct
+{
+    Capture *capture;
+    Scaler *scaler;             // NULL if the capture is panel sized
+    Converter *converter;       // initialised; changedRows is set here
+    Output *output;
+    Stats *stats;               // NULL to time nothing
+    int64_t statsInterval;      // nanoseconds between stats writes
+
+    int64_t framePeriod;        // nanoseconds
+    int64_t idlePeriod;
+    uint32_t idleFrames;        // 0 never to idle
+    bool vsync;
+    bool dynamicRegion;
+    bool threaded;
+    bool once;                  // one frame only, always sequential
+    volatile bool *run;         // cleared to stop
+
+    Governor *governor;         // initialised, NULL for no CPU budget
+    DitherRowKernel orderedDither;  // instead of the converter's diffuser
+
+    // called on the capture thread when the governor has news
+    void (*governorChanged)(const Governor *governor);
+
+    // called with errno set when the stats file cannot be written
+    void (*statsError)(void);
+
+    // why runPipeline() stopped, NULL if run was cleared
+    const char *error;
+    int errorNumber;            // 0 at the end of a file capture
+} Pipeline;
+
+//-------------------------------------------------------------------------
+
+// Runs frames until run is cleared, the capture ends or a stage fails.
+// Returns false, with error and errorNumber set, in the last two cases.
+
+bool
+runPipeline(
+    Pipeline *pipeline);
+
+//-------------------------------------------------------------------------
+
+#endif
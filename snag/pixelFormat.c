@@ -0,0 +1,167 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <string.h>
+
+#include "dither.h"
+#include "pixelFormat.h"
+
+//-------------------------------------------------------------------------
+
+static void
+readRgb565(
+    const void *src,
+    uint16_t *dst,
+    uint32_t count,
+    const uint16_t *palette)
+{
+    memcpy(dst, src, count * sizeof(uint16_t));
+}
+
+//-------------------------------------------------------------------------
+
+static void
+readXrgb8888(
+    const void *src,
+    uint16_t *dst,
+    uint32_t count,
+    const uint16_t *palette)
+{
+    const uint32_t *pixels = src;
+
+    for (uint32_t x = 0; x < count; x++)
+    {
+        uint32_t p = pixels[x];
+
+        dst[x] = ((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+readXbgr8888(
+    const void *src,
+    uint16_t *dst,
+    uint32_t count,
+    const uint16_t *palette)
+{
+    const uint32_t *pixels = src;
+
+    for (uint32_t x = 0; x < count; x++)
+    {
+        uint32_t p = pixels[x];
+
+        dst[x] = ((p << 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 19) & 0x001F);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+readPalette8(
+    const void *src,
+    uint16_t *dst,
+    uint32_t count,
+    const uint16_t *palette)
+{
+    const uint8_t *indices = src;
+
+    for (uint32_t x = 0; x < count; x++)
+    {
+        dst[x] = palette[indices[x]];
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static const struct
+{
+    uint32_t bytes;
+    PixelReader read;
+} formats[] =
+{
+    [PIXEL_FORMAT_RGB565] = { 2, readRgb565 },
+    [PIXEL_FORMAT_XRGB8888] = { 4, readXrgb8888 },
+    [PIXEL_FORMAT_XBGR8888] = { 4, readXbgr8888 },
+    [PIXEL_FORMAT_PALETTE8] = { 1, readPalette8 },
+};
+
+//-------------------------------------------------------------------------
+
+uint32_t
+pixelFormatBytes(
+    PixelFormat format)
+{
+    return formats[format].bytes;
+}
+
+//-------------------------------------------------------------------------
+
+PixelReader
+scalarPixelReader(
+    PixelFormat format)
+{
+    return formats[format].read;
+}
+
+//-------------------------------------------------------------------------
+
+PixelReader
+neonPixelReader(
+    PixelFormat format)
+{
+    if (!cpuHasNeon())
+    {
+        return NULL;
+    }
+
+    for (const NeonPixelReader *reader = neonPixelReaders;
+         reader->read != NULL;
+         reader++)
+    {
+        if (reader->format == format)
+        {
+            return reader->read;
+        }
+    }
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+PixelReader
+selectPixelReader(
+    PixelFormat format)
+{
+    PixelReader neon = neonPixelReader(format);
+
+    return (neon != NULL) ? neon : scalarPixelReader(format);
+}
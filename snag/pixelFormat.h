@@ -0,0 +1,108 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Pixel formats a source can be in. Frames are RGB565 from capture on
+// (scale.h, convert.h and every dither kernel work on it), so each format
+// has a reader that converts a row while it is copied out of the source,
+// rather than in a pass of its own.
+
+typedef enum
+{
+    PIXEL_FORMAT_RGB565,
+    PIXEL_FORMAT_XRGB8888,      // B, G, R, X in memory; also ARGB8888
+    PIXEL_FORMAT_XBGR8888,      // R, G, B, X in memory; also ABGR8888
+    PIXEL_FORMAT_PALETTE8       // indices into a 256 color palette
+} PixelFormat;
+
+// Reads count pixels from src into dst. palette holds the RGB565 value of
+// each index for PIXEL_FORMAT_PALETTE8, and is ignored otherwise.
+
+typedef void
+(*PixelReader)(
+    const void *src,
+    uint16_t *dst,
+    uint32_t count,
+    const uint16_t *palette);
+
+//-------------------------------------------------------------------------
+
+static inline uint16_t
+rgb565(
+    uint8_t red,
+    uint8_t green,
+    uint8_t blue)
+{
+    return ((red & 0xF8) << 8) | ((green & 0xFC) << 3) | (blue >> 3);
+}
+
+uint32_t
+pixelFormatBytes(
+    PixelFormat format);
+
+// The portable C reader for format.
+
+PixelReader
+scalarPixelReader(
+    PixelFormat format);
+
+// The fastest reader for format: NEON when the CPU has it.
+
+PixelReader
+selectPixelReader(
+    PixelFormat format);
+
+// NEON reader for format, or NULL if the CPU has no NEON or the format
+// has no NEON reader.
+
+PixelReader
+neonPixelReader(
+    PixelFormat format);
+
+// The NEON readers (ditherNeon.c), ended by an entry with a NULL reader.
+// Only the end marker unless built with NEON.
+
+typedef struct
+{
+    PixelFormat format;
+    PixelReader read;
+} NeonPixelReader;
+
+extern const NeonPixelReader neonPixelReaders[];
+
+//-------------------------------------------------------------------------
+
+#endif
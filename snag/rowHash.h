@@ -3,6 +3,7 @@
 // The MIT License (MIT)
 //
 // Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
 //
 // Permission is hereby granted, free of charge, to any person obtaining a
 // copy of this software and associated documentation files (the
@@ -25,108 +26,63 @@
 //
 //-------------------------------------------------------------------------
 
-#include <errno.h>
-#include <stdarg.h>
-#include <stdbool.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <syslog.h>
-#include <unistd.h>
-
-#include "syslogUtilities.h"
+#ifndef ROW_HASH_H
+#define ROW_HASH_H
 
 //-------------------------------------------------------------------------
 
-void
-messageLog(
-    bool isDaemon,
-    const char *name,
-    int priority,
-    const char *format,
-    ...)
-{
-    va_list args;
-    va_start(args, format);
-
-    if (isDaemon)
-    {
-        vsyslog(LOG_MAKEPRI(LOG_USER, priority), format, args);
-    }
-    else
-    {
-        fprintf(stderr, "%s[%d]:", name, getpid());
-
-        switch (priority)
-        {
-        case LOG_DEBUG:
-
-            fprintf(stderr, "debug");
-            break;
-
-        case LOG_INFO:
-
-            fprintf(stderr, "info");
-            break;
-
-        case LOG_NOTICE:
-
-            fprintf(stderr, "notice");
-            break;
-
-        case LOG_WARNING:
-
-            fprintf(stderr, "warning");
-            break;
-
-        case LOG_ERR:
-
-            fprintf(stderr, "error");
-            break;
-
-        default:
+#include <stdint.h>
+#include <string.h>
 
-            fprintf(stderr, "unknown(%d)", priority);
-            break;
-        }
+//-------------------------------------------------------------------------
 
-        fprintf(stderr, ":");
+#define PIXELS_PER_WORD (sizeof(uint64_t) / sizeof(uint16_t))
 
-        vfprintf(stderr, format, args);
+//-------------------------------------------------------------------------
 
-        fprintf(stderr, "\n");
-    }
+// Loads four pixels as one word. Rows need not be 8-byte aligned, and
+// memcpy keeps the access legal under strict aliasing.
 
-    va_end(args);
+static inline uint64_t
+loadWord(
+    const uint16_t *pixels)
+{
+    uint64_t word;
+    memcpy(&word, pixels, sizeof(word));
+    return word;
 }
 
 //-------------------------------------------------------------------------
 
-void
-perrorLog(
-    bool isDaemon,
-    const char *name,
-    const char *s)
+// 64-bit FNV-1a style hash of a row of RGB565 pixels, a word at a time.
+// Used to skip rows that did not change since the last frame. The
+// multiply only carries bits upwards, so the top half is folded back in
+// after each step; otherwise changes in the top pixel of two words can
+// cancel.
+
+static inline uint64_t
+hashRow(
+    const uint16_t *row,
+    uint32_t width)
 {
-    messageLog(isDaemon,
-               name,
-               LOG_ERR,
-               "%s -  %s",
-               s,
-               strerror(errno));
-}
+    uint32_t count = width / PIXELS_PER_WORD;
+    uint64_t hash = 0xcbf29ce484222325ULL;
 
-//-------------------------------------------------------------------------
+    for (uint32_t i = 0; i < count; i++)
+    {
+        hash = (hash ^ loadWord(row + i * PIXELS_PER_WORD)) * 0x100000001b3ULL;
+        hash ^= hash >> 32;
+    }
 
-void
-exitAndRemovePidFile(
-    int status,
-    struct pidfh *pfh)
-{
-    if (pfh)
+    for (uint32_t x = count * PIXELS_PER_WORD; x < width; x++)
     {
-        pidfile_remove(pfh);
+        hash = (hash ^ row[x]) * 0x100000001b3ULL;
+        hash ^= hash >> 32;
     }
 
-    exit(status);
+    return hash;
 }
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,437 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rowHash.h"
+#include "scale.h"
+
+//-------------------------------------------------------------------------
+
+// RGB565 spread over a 32-bit word with room to add pixels: blue in bits
+// 0-4, red in bits 11-15 and green in bits 21-26, 6 spare bits above each
+#define SPREAD_MASK 0x07E0F81FU
+
+#define WEIGHT_ONE 256
+
+//-------------------------------------------------------------------------
+
+// Source pixels covered by one output pixel along an axis.
+
+typedef struct
+{
+    uint32_t first;
+    uint32_t count;
+    const uint16_t *weights;    // coverage of each, summing to WEIGHT_ONE
+} Tap;
+
+struct Scaler
+{
+    uint32_t srcWidth;
+    uint32_t srcHeight;
+    uint32_t dstWidth;
+    uint32_t dstHeight;
+    uint32_t factor;            // 2 or 3 for the block paths, else 0
+
+    uint64_t *srcHashes;
+    uint8_t *srcChanged;
+    bool scaleAll;
+    uint32_t firstRow;          // source rows that may change in the next
+    uint32_t lastRow;           // frame
+
+    // area averaging
+    Tap *columns;
+    Tap *rows;
+    uint16_t *weights;
+    uint32_t *sumRed;           // column sums of the source rows of a band
+    uint32_t *sumGreen;
+    uint32_t *sumBlue;
+};
+
+//-------------------------------------------------------------------------
+
+static inline uint32_t
+spread(
+    uint16_t pixel)
+{
+    return (pixel | ((uint32_t)pixel << 16)) & SPREAD_MASK;
+}
+
+static inline uint16_t
+unspread(
+    uint32_t sum)
+{
+    sum &= SPREAD_MASK;
+
+    return (sum | (sum >> 16)) & 0xFFFF;
+}
+
+//-------------------------------------------------------------------------
+
+// Splits srcLength pixels evenly over dstLength pixels. Output pixel i
+// covers [i * srcLength, (i + 1) * srcLength) in units of 1/dstLength of
+// a source pixel; weights are cumulative differences so they sum exactly.
+
+static void
+buildTaps(
+    Tap *taps,
+    uint16_t *weights,
+    uint32_t srcLength,
+    uint32_t dstLength)
+{
+    for (uint32_t i = 0; i < dstLength; i++)
+    {
+        uint64_t start = (uint64_t)i * srcLength;
+        uint64_t end = start + srcLength;
+
+        taps[i].first = start / dstLength;
+        taps[i].count = (end - 1) / dstLength - taps[i].first + 1;
+        taps[i].weights = weights;
+
+        for (uint32_t j = taps[i].first; j < taps[i].first + taps[i].count; j++)
+        {
+            uint64_t low = (j * (uint64_t)dstLength > start) ? j * (uint64_t)dstLength : start;
+            uint64_t high = ((j + 1) * (uint64_t)dstLength < end) ? (j + 1) * (uint64_t)dstLength : end;
+
+            *weights++ = ((high - start) * WEIGHT_ONE) / srcLength -
+                         ((low - start) * WEIGHT_ONE) / srcLength;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+scaleRow2x(
+    const Scaler *scaler,
+    const uint16_t *src,
+    uint32_t srcPitch,
+    uint16_t *dst)
+{
+    const uint16_t *top = src;
+    const uint16_t *bottom = src + srcPitch;
+
+    for (uint32_t x = 0; x < scaler->dstWidth; x++, top += 2, bottom += 2)
+    {
+        uint32_t sum = spread(top[0]) + spread(top[1]) +
+                       spread(bottom[0]) + spread(bottom[1]) +
+                       spread(0x1042);  // 2 in each channel, rounds the average
+
+        dst[x] = unspread(sum >> 2);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// x / 9 rounded, exact for the largest sum of 9 six-bit values
+#define DIVIDE_BY_9(x) (((x) * 7282 + 32768) >> 16)
+
+static void
+scaleRow3x(
+    const Scaler *scaler,
+    const uint16_t *src,
+    uint32_t srcPitch,
+    uint16_t *dst)
+{
+    const uint16_t *r0 = src;
+    const uint16_t *r1 = src + srcPitch;
+    const uint16_t *r2 = src + 2 * srcPitch;
+
+    for (uint32_t x = 0; x < scaler->dstWidth; x++, r0 += 3, r1 += 3, r2 += 3)
+    {
+        uint32_t sum = spread(r0[0]) + spread(r0[1]) + spread(r0[2]) +
+                       spread(r1[0]) + spread(r1[1]) + spread(r1[2]) +
+                       spread(r2[0]) + spread(r2[1]) + spread(r2[2]);
+
+        uint32_t blue = DIVIDE_BY_9(sum & 0x3FF);
+        uint32_t red = DIVIDE_BY_9((sum >> 11) & 0x3FF);
+        uint32_t green = DIVIDE_BY_9((sum >> 21) & 0x7FF);
+
+        dst[x] = (red << 11) | (green << 5) | blue;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+scaleRowArea(
+    const Scaler *scaler,
+    const Tap *row,
+    const uint16_t *src,
+    uint32_t srcPitch,
+    uint16_t *dst)
+{
+    uint32_t *sumRed = scaler->sumRed;
+    uint32_t *sumGreen = scaler->sumGreen;
+    uint32_t *sumBlue = scaler->sumBlue;
+
+    memset(sumRed, 0, scaler->srcWidth * sizeof(uint32_t));
+    memset(sumGreen, 0, scaler->srcWidth * sizeof(uint32_t));
+    memset(sumBlue, 0, scaler->srcWidth * sizeof(uint32_t));
+
+    // vertical pass: weighted column sums over the band of source rows
+    for (uint32_t k = 0; k < row->count; k++)
+    {
+        const uint16_t *line = src + (row->first + k) * srcPitch;
+        uint32_t weight = row->weights[k];
+
+        for (uint32_t x = 0; x < scaler->srcWidth; x++)
+        {
+            uint16_t pixel = line[x];
+
+            sumRed[x] += (pixel >> 11) * weight;
+            sumGreen[x] += ((pixel >> 5) & 0x3F) * weight;
+            sumBlue[x] += (pixel & 0x1F) * weight;
+        }
+    }
+
+    // horizontal pass, weights multiply to WEIGHT_ONE squared
+    for (uint32_t x = 0; x < scaler->dstWidth; x++)
+    {
+        const Tap *column = &scaler->columns[x];
+        uint32_t red = WEIGHT_ONE * WEIGHT_ONE / 2;
+        uint32_t green = red;
+        uint32_t blue = red;
+
+        for (uint32_t k = 0; k < column->count; k++)
+        {
+            uint32_t i = column->first + k;
+            uint32_t weight = column->weights[k];
+
+            red += sumRed[i] * weight;
+            green += sumGreen[i] * weight;
+            blue += sumBlue[i] * weight;
+        }
+
+        dst[x] = ((red >> 16) << 11) | ((green >> 16) << 5) | (blue >> 16);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+Scaler *
+createScaler(
+    uint32_t srcWidth,
+    uint32_t srcHeight,
+    uint32_t dstWidth,
+    uint32_t dstHeight)
+{
+    Scaler *scaler = calloc(1, sizeof(Scaler));
+
+    if (scaler == NULL)
+    {
+        return NULL;
+    }
+
+    scaler->srcWidth = srcWidth;
+    scaler->srcHeight = srcHeight;
+    scaler->dstWidth = dstWidth;
+    scaler->dstHeight = dstHeight;
+    scaler->scaleAll = true;
+    scaler->firstRow = 0;
+    scaler->lastRow = srcHeight;
+
+    for (uint32_t factor = 2; factor <= 3; factor++)
+    {
+        if ((srcWidth == factor * dstWidth) && (srcHeight == factor * dstHeight))
+        {
+            scaler->factor = factor;
+        }
+    }
+
+    scaler->srcHashes = calloc(srcHeight, sizeof(uint64_t));
+    scaler->srcChanged = calloc(srcHeight, 1);
+
+    bool ok = (scaler->srcHashes != NULL) && (scaler->srcChanged != NULL);
+
+    if (ok && (scaler->factor == 0))
+    {
+        scaler->columns = calloc(dstWidth, sizeof(Tap));
+        scaler->rows = calloc(dstHeight, sizeof(Tap));
+        scaler->weights = calloc(srcWidth + dstWidth + srcHeight + dstHeight,
+                                 sizeof(uint16_t));
+        scaler->sumRed = calloc(srcWidth, sizeof(uint32_t));
+        scaler->sumGreen = calloc(srcWidth, sizeof(uint32_t));
+        scaler->sumBlue = calloc(srcWidth, sizeof(uint32_t));
+
+        ok = (scaler->columns != NULL) &&
+             (scaler->rows != NULL) &&
+             (scaler->weights != NULL) &&
+             (scaler->sumRed != NULL) &&
+             (scaler->sumGreen != NULL) &&
+             (scaler->sumBlue != NULL);
+
+        if (ok)
+        {
+            buildTaps(scaler->columns, scaler->weights, srcWidth, dstWidth);
+            buildTaps(scaler->rows,
+                      scaler->weights + srcWidth + dstWidth,
+                      srcHeight,
+                      dstHeight);
+        }
+    }
+
+    if (!ok)
+    {
+        destroyScaler(scaler);
+        return NULL;
+    }
+
+    return scaler;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyScaler(
+    Scaler *scaler)
+{
+    if (scaler == NULL)
+    {
+        return;
+    }
+
+    free(scaler->sumBlue);
+    free(scaler->sumGreen);
+    free(scaler->sumRed);
+    free(scaler->weights);
+    free(scaler->rows);
+    free(scaler->columns);
+    free(scaler->srcChanged);
+    free(scaler->srcHashes);
+    free(scaler);
+}
+
+//-------------------------------------------------------------------------
+
+const char *
+scalerName(
+    const Scaler *scaler)
+{
+    switch (scaler->factor)
+    {
+    case 2:
+        return "2x";
+    case 3:
+        return "3x";
+    default:
+        return "area-averaging";
+    }
+}
+
+//-------------------------------------------------------------------------
+
+uint32_t
+scaleFrame(
+    Scaler *scaler,
+    const uint16_t *src,
+    uint32_t srcPitch,
+    uint16_t *dst,
+    const uint16_t *prev,
+    uint32_t dstPitch)
+{
+    for (uint32_t y = 0; y < scaler->srcHeight; y++)
+    {
+        if (((y < scaler->firstRow) || (y >= scaler->lastRow)) && !scaler->scaleAll)
+        {
+            scaler->srcChanged[y] = 0;
+            continue;
+        }
+
+        uint64_t hash = hashRow(src + y * srcPitch, scaler->srcWidth);
+
+        scaler->srcChanged[y] = (hash != scaler->srcHashes[y]) || scaler->scaleAll;
+        scaler->srcHashes[y] = hash;
+    }
+
+    scaler->scaleAll = false;
+    scaler->firstRow = 0;
+    scaler->lastRow = scaler->srcHeight;
+
+    uint32_t scaled = 0;
+
+    for (uint32_t y = 0; y < scaler->dstHeight; y++)
+    {
+        uint32_t first = (scaler->factor != 0) ? y * scaler->factor
+                                               : scaler->rows[y].first;
+        uint32_t count = (scaler->factor != 0) ? scaler->factor
+                                               : scaler->rows[y].count;
+        bool changed = false;
+
+        for (uint32_t k = 0; k < count; k++)
+        {
+            changed = changed || scaler->srcChanged[first + k];
+        }
+
+        uint16_t *row = dst + y * dstPitch;
+
+        if (!changed)
+        {
+            if (prev != dst)
+            {
+                memcpy(row, prev + y * dstPitch, scaler->dstWidth * sizeof(uint16_t));
+            }
+
+            continue;
+        }
+
+        const uint16_t *band = src + first * srcPitch;
+
+        switch (scaler->factor)
+        {
+        case 2:
+            scaleRow2x(scaler, band, srcPitch, row);
+            break;
+        case 3:
+            scaleRow3x(scaler, band, srcPitch, row);
+            break;
+        default:
+            scaleRowArea(scaler, &scaler->rows[y], src, srcPitch, row);
+            break;
+        }
+
+        ++scaled;
+    }
+
+    return scaled;
+}
+
+//-------------------------------------------------------------------------
+
+void
+limitScaleRows(
+    Scaler *scaler,
+    uint32_t firstRow,
+    uint32_t lastRow)
+{
+    scaler->firstRow = firstRow;
+    scaler->lastRow = lastRow;
+}
@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef SCALE_H
+#define SCALE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Downscales captured RGB565 frames to the panel size by area averaging:
+// each output pixel is the average of the source pixels it covers,
+// weighted by how much of each it covers (8-bit fixed point per axis).
+// Exact 2x and 3x reductions have their own paths that add the channels
+// of all pixels of a block in one 32-bit word. The channels are averaged
+// before the luma lookup, so every dither kernel works on the result
+// unchanged and gamma/contrast apply to the averaged gray.
+//
+// Source rows are hashed, and only output rows whose source rows changed
+// are scaled again; the others are copied from the previous output frame.
+
+typedef struct Scaler Scaler;
+
+//-------------------------------------------------------------------------
+
+Scaler *
+createScaler(
+    uint32_t srcWidth,
+    uint32_t srcHeight,
+    uint32_t dstWidth,
+    uint32_t dstHeight);
+
+void
+destroyScaler(
+    Scaler *scaler);
+
+// "2x", "3x" or "area-averaging", for logging
+
+const char *
+scalerName(
+    const Scaler *scaler);
+
+// Scales src into dst. prev is the previous output frame (same pitch),
+// rows that did not change are copied from it (it may be dst itself).
+// Pitches are in pixels.
+// Returns the number of rows scaled.
+
+uint32_t
+scaleFrame(
+    Scaler *scaler,
+    const uint16_t *src,
+    uint32_t srcPitch,
+    uint16_t *dst,
+    const uint16_t *prev,
+    uint32_t dstPitch);
+
+// Tells the next scaleFrame() that only source rows firstRow to lastRow
+// may have changed; the others are not even hashed.
+
+void
+limitScaleRows(
+    Scaler *scaler,
+    uint32_t firstRow,
+    uint32_t lastRow);
+
+//-------------------------------------------------------------------------
+
+#endif
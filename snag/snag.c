@@ -29,9 +29,9 @@
 #define _GNU_SOURCE
 
 #include <errno.h>
-#include <fcntl.h>
 #include <getopt.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -42,25 +42,41 @@
 #include <unistd.h>
 
 #include <bsd/libutil.h>
-#include <linux/fb.h>
-
-#include <sys/ioctl.h>
-#include <sys/mman.h>
-#include <sys/time.h>
-
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
-#include "bcm_host.h"
-#pragma GCC diagnostic pop
 
+#include "capture.h"
+#include "console.h"
+#include "convert.h"
+#include "dither.h"
+#include "governor.h"
+#include "luma.h"
+#include "output.h"
+#include "pipeline.h"
+#include "scale.h"
+#include "stats.h"
 #include "syslogUtilities.h"
 
 //-------------------------------------------------------------------------
 
 #define DEFAULT_DEVICE "/dev/fb1"
+#define DEFAULT_OUTPUT "fb"
+#if defined(SNAG_HAVE_DISPMANX)
+#define DEFAULT_CAPTURE "dispmanx"
+#elif defined(SNAG_HAVE_DRM)
+#define DEFAULT_CAPTURE "drm"
+#else
+#define DEFAULT_CAPTURE "fbdev"
+#endif
 #define DEFAULT_DISPLAY_NUMBER 0
 #define DEFAULT_FPS 30
 #define DEFAULT_DITHER_METHOD "4x4"
+#define DEFAULT_GAMMA 1.0
+#define DEFAULT_CONTRAST 1.0
+#define DEFAULT_THREADS 1
+#define DEFAULT_IDLE_FRAMES 30
+#define DEFAULT_IDLE_FPS 2
+
+#define NANOSECONDS_PER_SECOND 1000000000L
+#define STATS_INTERVAL_SECONDS 10
 
 #define DEBUG_INT(x) printf( #x " at line %d; result: %d\n", __LINE__, x)
 #define DEBUG_C(x) printf( #x " at line %d; result: %c\n", __LINE__, x)
@@ -69,63 +85,6 @@
 //-------------------------------------------------------------------------
 
 
-// define bayer dither patterns
-const int BAYER2X2[2][2] =	
-{	//	2x2 Bayer Dithering Matrix. Color levels: 5
-	{  51, 206 },
-	{ 153, 102 }
-};
-
-const int BAYER3X3[3][3] =	
-{	//	3x3 Bayer Dithering Matrix. Color levels: 10
-	//{ 181, 231, 131 },
-	//{  50,  25, 100 },
-	//{ 156,  75, 206 }
-	{  75, 150, 225 },
-	{  50, 125, 200 },
-	{  25, 100, 175 }
-};
-
-const int BAYER4X4[4][4] =	
-{	//	4x4 Bayer Dithering Matrix. Color levels: 17
-	{  15, 195,  60, 240 },
-	{ 135,  75, 180, 120 },
-	{  45, 225,  30, 210 },
-	{ 165, 105, 150,  90 }
-};
-
-const int BAYER8X8[8][8] =	
-{	//	8x8 Bayer Dithering Matrix. Color levels: 65
-	{   0, 128,  32, 160,   8, 136,  40, 168 },
-	{ 192,  64, 224,  96, 200,  72, 232, 104 },
-	{  48, 176,  16, 144,  56, 184,  24, 152 },
-	{ 240, 112, 208,  80, 248, 120, 216,  88 },
-	{  12, 140,  44, 172,   4, 132,  36, 164 },
-	{ 204,  76, 236, 108, 196,  68, 228, 100 },
-	{  60, 188,  28, 156,  52, 180,  20, 148 },
-	{ 252, 124, 220,  92, 244, 116, 212,  84 }
-};
-
-const int BAYER16X16[16][16] =	
-{	//	16x16 Bayer Dithering Matrix.  Color levels: 256
-	{   0, 191,  48, 239,  12, 203,  60, 251,   3, 194,  51, 242,  15, 206,  63, 254 }, 
-	{ 127,  64, 175, 112, 139,  76, 187, 124, 130,  67, 178, 115, 142,  79, 190, 127 },
-	{  32, 223,  16, 207,  44, 235,  28, 219,  35, 226,  19, 210,  47, 238,  31, 222 },
-	{ 159,  96, 143,  80, 171, 108, 155,  92, 162,  99, 146,  83, 174, 111, 158,  95 },
-	{   8, 199,  56, 247,   4, 195,  52, 243,  11, 202,  59, 250,   7, 198,  55, 246 },
-	{ 135,  72, 183, 120, 131,  68, 179, 116, 138,  75, 186, 123, 134,  71, 182, 119 },
-	{  40, 231,  24, 215,  36, 227,  20, 211,  43, 234,  27, 218,  39, 230,  23, 214 },
-	{ 167, 104, 151,  88, 163, 100, 147,  84, 170, 107, 154,  91, 166, 103, 150,  87 },
-	{   2, 193,  50, 241,  14, 205,  62, 253,   1, 192,  49, 240,  13, 204,  61, 252 },
-	{ 129,  66, 177, 114, 141,  78, 189, 126, 128,  65, 176, 113, 140,  77, 188, 125 },
-	{  34, 225,  18, 209,  46, 237,  30, 221,  33, 224,  17, 208,  45, 236,  29, 220 },
-	{ 161,  98, 145,  82, 173, 110, 157,  94, 160,  97, 144,  81, 172, 109, 156,  93 },
-	{  10, 201,  58, 249,   6, 197,  54, 245,   9, 200,  57, 248,   5, 196,  53, 244 },
-	{ 137,  74, 185, 122, 133,  70, 181, 118, 136,  73, 184, 121, 132,  69, 180, 117 },
-	{  42, 233,  26, 217,  38, 229,  22, 213,  41, 232,  25, 216,  37, 228,  21, 212 },
-	{ 169, 106, 153,  90, 165, 102, 149,  86, 168, 105, 152,  89, 164, 101, 148,  85 }
-};
-
 volatile bool run = true;
 
 //-------------------------------------------------------------------------
@@ -138,10 +97,24 @@ void printUsage( FILE *fp, const char *name)
 	fprintf(fp, "Options:\n");	
 	fprintf(fp, "  --daemon              Start in the background as a daemon\n");	
 	fprintf(fp, "  --device <device>     Framebuffer device (default %s)\n", DEFAULT_DEVICE);	
+	fprintf(fp, "  --output <output>     fb[:<device>] (8bpp or packed 1bpp), or spidev:<device> to drive the panel directly (default %s)\n", DEFAULT_OUTPUT);
 	fprintf(fp, "  --display <number>    Raspberry Pi display number (default %d)\n", DEFAULT_DISPLAY_NUMBER);	
+	fprintf(fp, "  --capture <source>    dispmanx[:<number>], fbdev[:<device>], drm[:<device>], x11[:<display>] or file:<w>x<h>[x<bits>]:<path> (default %s)\n", DEFAULT_CAPTURE);
+	fprintf(fp, "  --console <n>         Mirror the text of virtual console n (0 for the one shown) instead of capturing pixels\n");
+	fprintf(fp, "  --region <x,y,w,h>    Capture only this rectangle of the source, scaled to the panel\n");
+	fprintf(fp, "  --dynamic-region      Capture and convert only around recent changes, all of it every few frames\n");
 	fprintf(fp, "  --fps <fps>           Set desired frames per second (default %d)\n", DEFAULT_FPS);	
-	fprintf(fp, "  --dither <type>       Set dither method (none/2x2/4x4/8x8/16x16) (default %s)\n", DEFAULT_DITHER_METHOD);	
+	fprintf(fp, "  --idle-frames <n>     Drop to --idle-fps after n unchanged frames, 0 never (default %d)\n", DEFAULT_IDLE_FRAMES);
+	fprintf(fp, "  --idle-fps <fps>      Frames per second while the screen is static (default %d)\n", DEFAULT_IDLE_FPS);
+	fprintf(fp, "  --cpu-budget <pct>    Stay within pct%% of a CPU by lowering the fps; ,region and ,dither also allow narrowing the capture and ordered dither\n");
+	fprintf(fp, "  --no-vsync            Do not wait for the display's vertical blank before a capture\n");
+	fprintf(fp, "  --dither <type>       Set dither method (none/2x2/3x3/4x4/8x8/16x16/bluenoise/floyd-steinberg/atkinson) (default %s)\n", DEFAULT_DITHER_METHOD);	
+	fprintf(fp, "  --gamma <value>       Gamma applied to gray levels, >1 brightens midtones (default %.1f)\n", DEFAULT_GAMMA);
+	fprintf(fp, "  --contrast <value>    Contrast applied to gray levels around mid-gray (default %.1f)\n", DEFAULT_CONTRAST);
+	fprintf(fp, "  --threads <n>         Convert frames with n threads (default %d)\n", DEFAULT_THREADS);
+	fprintf(fp, "  --no-pipeline         Capture, convert and write each frame in turn on one thread\n");
 	fprintf(fp, "  --pidfile <pidfile>   Create and lock PID file (if being run as a daemon)\n");	
+	fprintf(fp, "  --stats <file>        Time each stage and write percentiles to file every %d seconds\n", STATS_INTERVAL_SECONDS);
 	fprintf(fp, "  --once                Copy only one time, then exit\n");	
 	fprintf(fp, "  --help                Print usage and exit\n");
 }
@@ -160,19 +133,143 @@ static void signalHandler(int signalNumber)
 }
 
 
-void convertPixel(uint16_t pxl, uint16_t *red, uint16_t *green, uint16_t *blue) {
-	// Extract red, green, and blue components
-	*red = (pxl >> 11) & 0x1F;
-	*green = (pxl >> 5) & 0x3F;
-	*blue = pxl & 0x1F;
+//-------------------------------------------------------------------------
+
+// for the callbacks made while frames run
+
+static const char *logProgram = NULL;
+static bool logIsDaemon = false;
+
+static void logStatsError(void)
+{
+	perrorLog(logIsDaemon, logProgram, "cannot write the stats file");
+}
+
+static void logGovernor(const Governor *governor)
+{
+	double used = 100.0 * governor->used;
+	double budget = 100.0 * governor->budget;
+	double fps = (double)NANOSECONDS_PER_SECOND / governor->period;
 
-	// Convert 5-bit and 6-bit values to 8-bit values
-	*red = (*red << 3) | (*red >> 2);
-	*green = (*green << 2) | (*green >> 4);
-	*blue = (*blue << 3) | (*blue >> 2);
-	
-	//red = red * 8;
-	//green = red * 4;
+	switch (atomic_load(&governor->level))
+	{
+	case GOVERNOR_FULL_RATE:
+		messageLog(logIsDaemon, logProgram, LOG_INFO, "CPU %.1f%% of %.1f%% budget, back to full rate", used, budget);
+		break;
+	case GOVERNOR_REDUCED_RATE:
+		messageLog(logIsDaemon, logProgram, LOG_WARNING, "CPU %.1f%% of %.1f%% budget, frame rate reduced to %.1f fps", used, budget, fps);
+		break;
+	case GOVERNOR_REGION:
+		messageLog(logIsDaemon, logProgram, LOG_WARNING, "CPU %.1f%% of %.1f%% budget at %.1f fps, capturing only around changes", used, budget, fps);
+		break;
+	case GOVERNOR_DITHER:
+		messageLog(logIsDaemon, logProgram, LOG_WARNING, "CPU %.1f%% of %.1f%% budget at %.1f fps, ordered dither instead of error diffusion", used, budget, fps);
+		break;
+	}
+}
+
+//-------------------------------------------------------------------------
+
+// --console: draws the text of a virtual console from its cells and font,
+// with no capture, scaling or dithering, then exits.
+
+static void mirrorConsole(
+	const char *program,
+	bool isDaemon,
+	struct pidfh *pfh,
+	int consoleNumber,
+	const char *outputSpec,
+	const char *device,
+	const char *statsFile,
+	int64_t framePeriod,
+	int64_t idlePeriod,
+	bool once)
+{
+	char vcsaDevice[32];
+	char ttyDevice[32];
+
+	if (consoleNumber > 0)
+	{
+		snprintf(vcsaDevice, sizeof(vcsaDevice), "/dev/vcsa%d", consoleNumber);
+	}
+	else
+	{
+		snprintf(vcsaDevice, sizeof(vcsaDevice), "/dev/vcsa");
+	}
+
+	snprintf(ttyDevice, sizeof(ttyDevice), "/dev/tty%d", consoleNumber);
+
+	const char *reason = NULL;
+	Output *output = openOutput(outputSpec, device, &reason);
+
+	if (output == NULL)
+	{
+		perrorLog(isDaemon, program, reason);
+		exitAndRemovePidFile(EXIT_FAILURE, pfh);
+	}
+
+	Stats *stats = NULL;
+
+	if (statsFile != NULL)
+	{
+		stats = createStats(statsFile);
+
+		if (stats == NULL)
+		{
+			perrorLog(isDaemon, program, "cannot write the stats file");
+			closeOutput(output);
+			exitAndRemovePidFile(EXIT_FAILURE, pfh);
+		}
+	}
+
+	messageLog(isDaemon,
+			   program,
+			   LOG_INFO,
+			   "mirroring the text of %s to %s [%dx%d]",
+			   vcsaDevice,
+			   output->name,
+			   output->width,
+			   output->height);
+
+	ConsoleMirror mirror =
+	{
+		.device = vcsaDevice,
+		.fontDevice = ttyDevice,
+		.output = output,
+		.stats = stats,
+		.statsInterval = STATS_INTERVAL_SECONDS * NANOSECONDS_PER_SECOND,
+		.framePeriod = framePeriod,
+		.idlePeriod = idlePeriod,
+		.once = once,
+		.run = &run,
+		.statsError = logStatsError
+	};
+
+	int status = EXIT_SUCCESS;
+
+	if (!runConsoleMirror(&mirror))
+	{
+		errno = mirror.errorNumber;
+		perrorLog(isDaemon, program, mirror.error);
+		status = EXIT_FAILURE;
+	}
+
+	if ((stats != NULL) && !writeStats(stats))
+	{
+		perrorLog(isDaemon, program, "cannot write the stats file");
+	}
+
+	destroyStats(stats);
+	closeOutput(output);
+
+	messageLog(isDaemon, program, LOG_INFO, "exiting");
+
+	if (isDaemon)
+	{
+		closelog();
+	}
+
+	exitAndRemovePidFile(status, pfh);
 }
 
 //-------------------------------------------------------------------------
@@ -182,26 +279,57 @@ int main(int argc, char *argv[])
 	const char *program = basename(argv[0]);
 
 	int fps = DEFAULT_FPS;
-	suseconds_t frameDuration =  1000000 / fps;
+	int64_t framePeriod = NANOSECONDS_PER_SECOND / fps;
+	uint32_t idleFrames = DEFAULT_IDLE_FRAMES;
+	int64_t idlePeriod = NANOSECONDS_PER_SECOND / DEFAULT_IDLE_FPS;
+	bool vsync = true;
+	bool pipelined = true;
+	bool cropped = false;
+	bool dynamicRegion = false;
+	CaptureRect region = { 0, 0, 0, 0 };
 	bool isDaemon = false;
 	bool once = false;
 	uint32_t displayNumber = DEFAULT_DISPLAY_NUMBER;
 	char *dithermethod = DEFAULT_DITHER_METHOD;
+	double gamma = DEFAULT_GAMMA;
+	double contrast = DEFAULT_CONTRAST;
+	uint32_t threads = DEFAULT_THREADS;
 	const char *pidfile = NULL;
+	const char *statsFile = NULL;
 	const char *device = DEFAULT_DEVICE;
+	const char *outputSpec = DEFAULT_OUTPUT;
+	const char *captureSpec = DEFAULT_CAPTURE;
+	int consoleNumber = -1;
+	double cpuBudget = 0.0;
+	bool shedRegion = false;
+	bool shedDither = false;
 
 	//---------------------------------------------------------------------
 
-	static const char *sopts = "df:hn:b:p:D:o";
+	static const char *sopts = "df:hn:b:g:c:t:p:C:T:D:O:r:Ri:I:u:S:VPo";
 	static struct option lopts[] = 
 	{
 		{ "daemon", no_argument, NULL, 'd' },
 		{ "fps", required_argument, NULL, 'f' },
 		{ "help", no_argument, NULL, 'h' },
 		{ "display", required_argument, NULL, 'n' },
+		{ "capture", required_argument, NULL, 'C' },
+		{ "console", required_argument, NULL, 'T' },
+		{ "region", required_argument, NULL, 'r' },
+		{ "dynamic-region", no_argument, NULL, 'R' },
 		{ "dither", required_argument, NULL, 'b'},
+		{ "gamma", required_argument, NULL, 'g' },
+		{ "contrast", required_argument, NULL, 'c' },
+		{ "threads", required_argument, NULL, 't' },
 		{ "pidfile", required_argument, NULL, 'p' },
 		{ "device", required_argument, NULL, 'D' },
+		{ "output", required_argument, NULL, 'O' },
+		{ "idle-frames", required_argument, NULL, 'i' },
+		{ "idle-fps", required_argument, NULL, 'I' },
+		{ "cpu-budget", required_argument, NULL, 'u' },
+		{ "no-vsync", no_argument, NULL, 'V' },
+		{ "no-pipeline", no_argument, NULL, 'P' },
+		{ "stats", required_argument, NULL, 'S' },
 		{ "once", no_argument, NULL, 'o' },
 		{ NULL, no_argument, NULL, 0 }
 	};
@@ -215,6 +343,15 @@ int main(int argc, char *argv[])
 			case 'b':	
 				dithermethod = optarg;	
 				break;
+			case 'c':
+				contrast = atof(optarg);
+				break;
+			case 'C':
+				captureSpec = optarg;
+				break;
+			case 'T':
+				consoleNumber = atoi(optarg) > 0 ? atoi(optarg) : 0;
+				break;
 			case 'd':
 				isDaemon = true;
 				break;
@@ -222,11 +359,37 @@ int main(int argc, char *argv[])
 				fps = atoi(optarg);
 				if (fps > 0)
 				{
-					frameDuration = 1000000 / fps;
+					framePeriod = NANOSECONDS_PER_SECOND / fps;
 				}
 				else
 				{
-					fps = 1000000 / frameDuration;
+					fps = NANOSECONDS_PER_SECOND / framePeriod;
+				}
+				break;
+			case 'i':
+				idleFrames = atoi(optarg) > 0 ? atoi(optarg) : 0;
+				break;
+			case 'I':
+				if (atoi(optarg) > 0)
+				{
+					idlePeriod = NANOSECONDS_PER_SECOND / atoi(optarg);
+				}
+				break;
+			case 'u':
+				cpuBudget = atof(optarg) / 100.0;
+				shedRegion = (strstr(optarg, ",region") != NULL);
+				shedDither = (strstr(optarg, ",dither") != NULL);
+				if ((cpuBudget <= 0.0) || (cpuBudget > 1.0))
+				{
+					fprintf(stderr, "%s: --cpu-budget needs a percentage of a CPU, e.g. 5%%\n", program);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'g':
+				gamma = atof(optarg);
+				if (gamma <= 0.0)
+				{
+					gamma = DEFAULT_GAMMA;
 				}
 				break;
 			case 'h':
@@ -239,12 +402,43 @@ int main(int argc, char *argv[])
 			case 'p':
 				pidfile = optarg;
 				break;
+			case 'S':
+				statsFile = optarg;
+				break;
 			case 'o':
 				once = true;
 				break;
+			case 'V':
+				vsync = false;
+				break;
+			case 'P':
+				pipelined = false;
+				break;
+			case 'r':
+				if (sscanf(optarg,
+						   "%u,%u,%u,%u",
+						   &region.x,
+						   &region.y,
+						   &region.width,
+						   &region.height) != 4)
+				{
+					fprintf(stderr, "%s: --region needs x,y,width,height\n", program);
+					exit(EXIT_FAILURE);
+				}
+				cropped = true;
+				break;
+			case 'R':
+				dynamicRegion = true;
+				break;
+			case 't':
+				threads = atoi(optarg) > 0 ? atoi(optarg) : DEFAULT_THREADS;
+				break;
 			case 'D':
 				device = optarg;
 				break;
+			case 'O':
+				outputSpec = optarg;
+				break;
 			default:
 				printUsage(stderr, program);
 				exit(EXIT_FAILURE);
@@ -252,6 +446,15 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	const DitherMethod *dither = findDitherMethod(dithermethod);
+
+	if (dither == NULL)
+	{
+		fprintf(stderr, "%s: unknown dither method %s\n", program, dithermethod);
+		printUsage(stderr, program);
+		exit(EXIT_FAILURE);
+	}
+
 	//---------------------------------------------------------------------
 
 	struct pidfh *pfh = NULL;
@@ -287,6 +490,9 @@ int main(int argc, char *argv[])
 		openlog(program, LOG_PID, LOG_USER);
 	}
 
+	logProgram = program;
+	logIsDaemon = isDaemon;
+
 	//---------------------------------------------------------------------
 
 	if (signal(SIGINT, signalHandler) == SIG_ERR)
@@ -305,245 +511,253 @@ int main(int argc, char *argv[])
 
 	//---------------------------------------------------------------------
 
-	bcm_host_init();
-
-	DISPMANX_DISPLAY_HANDLE_T display = vc_dispmanx_display_open(displayNumber);
-
-	if (display == 0)
+	if (consoleNumber >= 0)
 	{
-		messageLog(isDaemon, program, LOG_ERR, "cannot open display");
-		exitAndRemovePidFile(EXIT_FAILURE, pfh);
+		mirrorConsole(program,
+					  isDaemon,
+					  pfh,
+					  consoleNumber,
+					  outputSpec,
+					  device,
+					  statsFile,
+					  framePeriod,
+					  idlePeriod,
+					  once);
 	}
 
-	DISPMANX_MODEINFO_T info;
+	//---------------------------------------------------------------------
+
+	buildLumaTable(gamma, contrast);
+
+	bool linearLuma = (gamma == DEFAULT_GAMMA) && (contrast == DEFAULT_CONTRAST);
+	DitherRowKernel ditherRow = selectDitherKernel(dither, linearLuma);
 
-	if (vc_dispmanx_display_get_info(display, &info) != 0)
+	if (ditherRow != dither->row)
 	{
-		messageLog(isDaemon,
-				   program,
-				   LOG_ERR,
-				   "cannot get display dimensions");
-		exitAndRemovePidFile(EXIT_FAILURE, pfh);
+		messageLog(isDaemon, program, LOG_INFO, "using NEON %s dither kernel", dither->name);
 	}
 
 	//---------------------------------------------------------------------
 
-	int fb1 = open(device, O_RDWR);
+	// the display is captured at its own size and scaled down on the CPU
+	const char *reason = NULL;
+	Capture *capture = openCapture(captureSpec, displayNumber, &reason);
 
-	if (fb1 == -1)
+	if (capture == NULL)
 	{
-		perrorLog(isDaemon, program, "cannot open framebuffer device");
+		perrorLog(isDaemon, program, reason);
 		exitAndRemovePidFile(EXIT_FAILURE, pfh);
 	}
 
-	struct fb_fix_screeninfo finfo;
-
-	if (ioctl(fb1, FBIOGET_FSCREENINFO, &finfo) == -1)
+	if (cropped && !setCaptureRegion(capture, &region))
 	{
-		perrorLog(isDaemon,
-				  program,
-				  "cannot get framebuffer fixed information");
+		perrorLog(isDaemon, program, "--region is not inside the captured display");
+		closeCapture(capture);
 		exitAndRemovePidFile(EXIT_FAILURE, pfh);
 	}
 
-	struct fb_var_screeninfo vinfo;
+	Output *output = openOutput(outputSpec, device, &reason);
 
-	if (ioctl(fb1, FBIOGET_VSCREENINFO, &vinfo) == -1)
+	if (output == NULL)
 	{
-		perrorLog(isDaemon,
-				  program,
-				  "cannot get framebuffer variable information");
+		perrorLog(isDaemon, program, reason);
+		closeCapture(capture);
 		exitAndRemovePidFile(EXIT_FAILURE, pfh);
 	}
 
-	//---------------------------------------------------------------------
-
-	if ((vinfo.xres % 16) != 0)
-	{
-		perrorLog(isDaemon,
-				  program,
-				  "framebuffer width must be a multiple of 16");
-		//exitAndRemovePidFile(EXIT_FAILURE, pfh);
-	}
+	uint32_t sourceWidth = capture->width;
+	uint32_t sourceHeight = capture->height;
+	uint32_t width = output->width;
+	uint32_t height = output->height;
+	uint32_t line_len = output->pitch;
 
 	//---------------------------------------------------------------------
 
-	DEBUG_INT(finfo.smem_len);
-	int chunks = finfo.smem_len/8;
-	uint8_t *fb1_data = mmap(0,
- 						chunks,
- 						PROT_READ | PROT_WRITE,
- 						MAP_SHARED,
- 						fb1,
- 						0);
+	Scaler *scaler = NULL;
 
-	if (fb1_data == MAP_FAILED)
+	if ((sourceWidth != width) || (sourceHeight != height))
 	{
-		perrorLog(isDaemon, program, "cannot map framebuffer into memory");
-		exitAndRemovePidFile(EXIT_FAILURE, pfh);
-	}
-
-	memset(fb1_data, 0, chunks);
-
-	//---------------------------------------------------------------------
+		scaler = createScaler(sourceWidth, sourceHeight, width, height);
 
-	uint32_t image_ptr;
-
-	DISPMANX_RESOURCE_HANDLE_T resourceHandle;
-	VC_RECT_T rect;
-
-	resourceHandle = vc_dispmanx_resource_create(VC_IMAGE_RGB565,
-												 vinfo.xres,
-												 vinfo.yres,
-												 &image_ptr);
-	vc_dispmanx_rect_set(&rect, 0, 0, vinfo.xres, vinfo.yres);
+		if (scaler == NULL)
+		{
+			perrorLog(isDaemon, program, "cannot allocate scaling buffers");
+			exitAndRemovePidFile(EXIT_FAILURE, pfh);
+		}
+	}
 
 	//---------------------------------------------------------------------
 
-	uint32_t len = finfo.smem_len;
+	Converter converter =
+	{
+		.width = width,
+		.height = height,
+		.srcPitch = line_len,
+		.dstPitch = line_len,
+		.ditherRow = ditherRow,
+		.workers = NULL
+	};
 
-	uint16_t *old_data = malloc(len);
-	uint16_t *new_data = malloc(len);
+	if (dither->diffusion != DIFFUSION_NONE)
+	{
+		converter.diffuser = createDiffuser(dither->diffusion, width, height);
 
-	uint32_t line_len = finfo.line_length;
+		if (converter.diffuser == NULL)
+		{
+			perrorLog(isDaemon, program, "cannot allocate error diffusion rows");
+			exitAndRemovePidFile(EXIT_FAILURE, pfh);
+		}
+	}
 
-	if ((old_data == NULL) || (new_data == NULL))
+	if (!initConverter(&converter))
 	{
-		perrorLog(isDaemon, program, "cannot allocate offscreen buffers");
+		perrorLog(isDaemon, program, "cannot allocate row hashes");
 		exitAndRemovePidFile(EXIT_FAILURE, pfh);
 	}
 
-	memset(old_data, 1, finfo.line_length * vinfo.yres);
+	if ((threads > 1) && (converter.diffuser != NULL))
+	{
+		messageLog(isDaemon, program, LOG_INFO, "error diffusion runs on one thread, ignoring --threads");
+	}
+	else if (threads > 1)
+	{
+		// strips start on a dither period so each thread sees whole patterns
+		converter.workers = createWorkers(threads, height, dither->period);
+
+		if (converter.workers == NULL)
+		{
+			messageLog(isDaemon, program, LOG_WARNING, "cannot start worker threads, converting on one thread");
+		}
+	}
 
 	//---------------------------------------------------------------------
 
-	messageLog(isDaemon,
-			   program,
-			   LOG_INFO,
-			   "snag normal scaling mode, copying from source fb[%dx%d] to dest fb [%dx%d]",
-			   info.width,
-			   info.height,
-			   vinfo.xres,
-			   vinfo.yres);
+	if (scaler != NULL)
+	{
+		messageLog(isDaemon,
+				   program,
+				   LOG_INFO,
+				   "scaling %s [%dx%d] to %s [%dx%d] (%s)",
+				   capture->name,
+				   sourceWidth,
+				   sourceHeight,
+				   output->name,
+				   width,
+				   height,
+				   scalerName(scaler));
+	}
+	else
+	{
+		messageLog(isDaemon,
+				   program,
+				   LOG_INFO,
+				   "copying %s [%dx%d] unscaled to %s",
+				   capture->name,
+				   width,
+				   height,
+				   output->name);
+	}
 
 	//---------------------------------------------------------------------
 
-	struct timeval start_time;
-	struct timeval end_time;
-	struct timeval elapsed_time;
+	Stats *stats = NULL;
 
-	//---------------------------------------------------------------------
+	if (statsFile != NULL)
+	{
+		stats = createStats(statsFile);
 
-	while (run)
-	{
-		gettimeofday(&start_time, NULL);
-
-		//-----------------------------------------------------------------
-		
-		// grab HDMI display data and put it in new_data
-		vc_dispmanx_snapshot(display, resourceHandle, 0);
-		vc_dispmanx_resource_read_data(resourceHandle,
-									   &rect,
-									   new_data,
-									   line_len * 2);  // * 2 because source is 16 bit 
-		
-		// get the first 8 pixels of fb1 and the first pixel of new_data & old_data
-		uint16_t *new_pixel = new_data;
-		uint16_t *old_pixel = old_data;
-
-		char newbit;
-		char oldbit;
-		
-		// loop through pixels, compare new_pixel to old_pixel, update fb1_data if changed
-		for (uint32_t pixel = 0; pixel < 96000; pixel++)
+		if (stats == NULL)
 		{
-			if (*new_pixel != *old_pixel)
-			{	
-				// extract new rgb data for current pixel and convert to grayscale
-				uint16_t red, green, blue;
-				convertPixel(*new_pixel, &red, &green, &blue);
-								
-				uint16_t grayscale = (0.299 * red + 0.587 * green + 0.114 * blue);
-				
-				// Ensure grayscale value is within the range [0, 255]
-				grayscale = grayscale > 255 ? 255 : grayscale; 
-				
-				// pixel location
-				uint8_t col = pixel % 400;
-				uint8_t row = pixel / 400;
-
-				// fetch old data
-				oldbit = fb1_data[pixel];
-
-				if (strcmp(dithermethod, "2x2") == 0){
-					newbit = (grayscale < BAYER2X2[row % 2][col % 2] ? 0 : 1);
-				}
-				else if (strcmp(dithermethod, "3x3") == 0){
-					newbit = (grayscale < BAYER3X3[row % 3][col % 3] ? 0 : 1);
-				}
-				else if (strcmp(dithermethod, "4x4") == 0){
-					newbit = (grayscale < BAYER4X4[row % 4][col % 4] ? 0 : 1);
-				}
-				else if (strcmp(dithermethod, "8x8") == 0){
-					newbit = (grayscale < BAYER8X8[row % 8][col % 8] ? 0 : 1);
-				}
-				else if (strcmp(dithermethod, "16x16") == 0){
-					newbit = (grayscale < BAYER16X16[row % 16][col % 16] ? 0 : 1);
-				}
-				else{
-					newbit = (grayscale < 140 ? 0 : 1);
-				}
-
-				if (oldbit != newbit)
-				{
-					fb1_data[pixel] = newbit;
-				}
-				
-			}
-				
-			++new_pixel;
-			++old_pixel;
+			perrorLog(isDaemon, program, "cannot write the stats file");
+			exitAndRemovePidFile(EXIT_FAILURE, pfh);
 		}
+	}
 
-		uint16_t *tmp = old_data;
-		old_data = new_data;
-		new_data = tmp;
-			
-		//-----------------------------------------------------------------
+	Governor governor =
+	{
+		.budget = cpuBudget,
+		.minPeriod = framePeriod,
+		.maxPeriod = (idlePeriod > framePeriod) ? idlePeriod : framePeriod,
+		.shedRegion = shedRegion && !dynamicRegion,
+		.shedDither = shedDither && (converter.diffuser != NULL)
+	};
 
-		if (once)
-		{
-			messageLog(isDaemon,
-					   program,
-					   LOG_INFO,
-					   "ran once, exiting now");
-			break;
-		}
+	if (cpuBudget > 0.0)
+	{
+		initGovernor(&governor);
+		messageLog(isDaemon,
+				   program,
+				   LOG_INFO,
+				   "keeping within %.1f%% of a CPU, %d to %.1f fps",
+				   100.0 * cpuBudget,
+				   fps,
+				   (double)NANOSECONDS_PER_SECOND / governor.maxPeriod);
+	}
+
+	if (vsync && (capture->waitVsync != NULL))
+	{
+		messageLog(isDaemon, program, LOG_INFO, "capturing on %s vertical blanks", capture->name);
+	}
+
+	if (pipelined && !once)
+	{
+		messageLog(isDaemon, program, LOG_INFO, "capturing, converting and writing on separate threads");
+	}
+
+	//---------------------------------------------------------------------
 
-		gettimeofday(&end_time, NULL);
-		timersub(&end_time, &start_time, &elapsed_time);
+	Pipeline pipeline =
+	{
+		.capture = capture,
+		.scaler = scaler,
+		.converter = &converter,
+		.output = output,
+		.stats = stats,
+		.statsInterval = STATS_INTERVAL_SECONDS * NANOSECONDS_PER_SECOND,
+		.framePeriod = framePeriod,
+		.idlePeriod = idlePeriod,
+		.idleFrames = idleFrames,
+		.vsync = vsync,
+		.dynamicRegion = dynamicRegion,
+		.threaded = pipelined,
+		.once = once,
+		.run = &run,
+		.governor = (cpuBudget > 0.0) ? &governor : NULL,
+		.orderedDither = selectDitherKernel(findDitherMethod(DEFAULT_DITHER_METHOD), linearLuma),
+		.governorChanged = logGovernor,
+		.statsError = logStatsError
+	};
 
-		if (elapsed_time.tv_sec == 0)
+	if (runPipeline(&pipeline))
+	{
+		if (once)
 		{
-			if (elapsed_time.tv_usec < frameDuration)
-			{
-				usleep(frameDuration -  elapsed_time.tv_usec);
-			}
+			messageLog(isDaemon, program, LOG_INFO, "ran once, exiting now");
 		}
 	}
+	else if (pipeline.errorNumber == 0)
+	{
+		messageLog(isDaemon, program, LOG_INFO, "end of %s input", capture->name);
+	}
+	else
+	{
+		errno = pipeline.errorNumber;
+		perrorLog(isDaemon, program, pipeline.error);
+	}
 
 	//---------------------------------------------------------------------
 
-	free(new_data);
-	free(old_data);
-	memset(fb1_data, 0, 96000);
-	munmap(fb1_data, 96000);
-	close(fb1);
+	if ((stats != NULL) && !writeStats(stats))
+	{
+		perrorLog(isDaemon, program, "cannot write the stats file");
+	}
 
-	//---------------------------------------------------------------------
+	destroyStats(stats);
+	freeConverter(&converter);
+	destroyScaler(scaler);
 
-	vc_dispmanx_resource_delete(resourceHandle);
-	vc_dispmanx_display_close(display);
+	closeOutput(output);
+	closeCapture(capture);
 
 	//---------------------------------------------------------------------
 
@@ -0,0 +1,319 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+
+//-------------------------------------------------------------------------
+
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+
+// values below 2 * SUB_BUCKETS have a bucket each, then every power of
+// two up to 2^63 is split into SUB_BUCKETS
+#define BUCKETS (SUB_BUCKETS * (64 - SUB_BUCKET_BITS + 1))
+
+typedef struct
+{
+    uint32_t counts[BUCKETS];   // since the last write
+    uint64_t windowCount;
+    uint64_t windowMax;
+    uint64_t count;             // since the start
+    uint64_t sum;
+} Histogram;
+
+struct Stats
+{
+    pthread_mutex_t lock;       // stages record from their own threads
+    char *path;
+    char *tmpPath;
+    Histogram histograms[STATS];
+};
+
+static const struct
+{
+    const char *metric;
+    const char *label;          // NULL for a metric of its own
+    double scale;
+}
+statNames[STATS] =
+{
+    [STAT_CAPTURE] = { "snag_stage_seconds", "capture", 1e-9 },
+    [STAT_SCALE] = { "snag_stage_seconds", "scale", 1e-9 },
+    [STAT_DIFF] = { "snag_stage_seconds", "diff", 1e-9 },
+    [STAT_CONVERT] = { "snag_stage_seconds", "convert", 1e-9 },
+    [STAT_WRITE] = { "snag_stage_seconds", "write", 1e-9 },
+    [STAT_FRAME] = { "snag_stage_seconds", "frame", 1e-9 },
+    [STAT_CHANGED_ROWS] = { "snag_changed_rows", NULL, 1.0 },
+    [STAT_CHANGED_PIXELS] = { "snag_changed_pixels", NULL, 1.0 },
+};
+
+static const double quantiles[] = { 0.5, 0.9, 0.99 };
+
+#define QUANTILES (sizeof(quantiles) / sizeof(quantiles[0]))
+
+//-------------------------------------------------------------------------
+
+static uint32_t
+bucketOf(
+    uint64_t value)
+{
+    if (value < 2 * SUB_BUCKETS)
+    {
+        return value;
+    }
+
+    uint32_t msb = 63 - __builtin_clzll(value);
+    uint32_t sub = (value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+    return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+//-------------------------------------------------------------------------
+
+// The largest value that falls in a bucket.
+
+static uint64_t
+bucketValue(
+    uint32_t bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    uint32_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = SUB_BUCKETS + bucket % SUB_BUCKETS;
+
+    return ((sub + 1) << shift) - 1;
+}
+
+//-------------------------------------------------------------------------
+
+static uint64_t
+quantileOf(
+    const Histogram *histogram,
+    double quantile)
+{
+    uint64_t rank = (uint64_t)(quantile * histogram->windowCount + 0.5);
+    uint64_t seen = 0;
+
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    for (uint32_t bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        seen += histogram->counts[bucket];
+
+        if (seen >= rank)
+        {
+            uint64_t value = bucketValue(bucket);
+            return (value < histogram->windowMax) ? value : histogram->windowMax;
+        }
+    }
+
+    return histogram->windowMax;
+}
+
+//-------------------------------------------------------------------------
+
+Stats *
+createStats(
+    const char *path)
+{
+    Stats *stats = calloc(1, sizeof(Stats));
+
+    if (stats == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_init(&stats->lock, NULL);
+    stats->path = strdup(path);
+    stats->tmpPath = malloc(strlen(path) + sizeof(".tmp"));
+
+    if ((stats->path == NULL) || (stats->tmpPath == NULL))
+    {
+        destroyStats(stats);
+        return NULL;
+    }
+
+    strcpy(stats->tmpPath, path);
+    strcat(stats->tmpPath, ".tmp");
+
+    if (!writeStats(stats))
+    {
+        destroyStats(stats);
+        return NULL;
+    }
+
+    return stats;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyStats(
+    Stats *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_destroy(&stats->lock);
+    free(stats->path);
+    free(stats->tmpPath);
+    free(stats);
+}
+
+//-------------------------------------------------------------------------
+
+void
+recordStat(
+    Stats *stats,
+    Stat stat,
+    uint64_t value)
+{
+    Histogram *histogram = &stats->histograms[stat];
+
+    pthread_mutex_lock(&stats->lock);
+
+    ++histogram->counts[bucketOf(value)];
+    ++histogram->windowCount;
+    ++histogram->count;
+    histogram->sum += value;
+
+    if (value > histogram->windowMax)
+    {
+        histogram->windowMax = value;
+    }
+
+    pthread_mutex_unlock(&stats->lock);
+}
+
+//-------------------------------------------------------------------------
+
+// Written to a temporary file and renamed over the old one, so a reader
+// never sees half a file.
+
+bool
+writeStats(
+    Stats *stats)
+{
+    FILE *fp = fopen(stats->tmpPath, "w");
+
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&stats->lock);
+
+    for (Stat stat = 0; stat < STATS; stat++)
+    {
+        Histogram *histogram = &stats->histograms[stat];
+        const char *metric = statNames[stat].metric;
+        double scale = statNames[stat].scale;
+        char label[32] = "";        // before the quantile label
+        char totalLabel[32] = "";   // on the _sum and _count series
+
+        if (statNames[stat].label != NULL)
+        {
+            snprintf(label, sizeof(label), "stage=\"%s\",", statNames[stat].label);
+            snprintf(totalLabel, sizeof(totalLabel), "{stage=\"%s\"}", statNames[stat].label);
+        }
+
+        if ((stat == 0) || (strcmp(metric, statNames[stat - 1].metric) != 0))
+        {
+            fprintf(fp, "# TYPE %s summary\n", metric);
+        }
+
+        // quantile 1 is the exact maximum
+        for (size_t i = 0; i <= QUANTILES; i++)
+        {
+            double quantile = (i < QUANTILES) ? quantiles[i] : 1.0;
+
+            fprintf(fp, "%s{%squantile=\"%g\"} ", metric, label, quantile);
+
+            if (histogram->windowCount == 0)
+            {
+                fprintf(fp, "NaN\n");
+            }
+            else if (i < QUANTILES)
+            {
+                fprintf(fp, "%.9g\n", quantileOf(histogram, quantile) * scale);
+            }
+            else
+            {
+                fprintf(fp, "%.9g\n", histogram->windowMax * scale);
+            }
+        }
+
+        fprintf(fp, "%s_sum%s %.9g\n", metric, totalLabel, histogram->sum * scale);
+        fprintf(fp, "%s_count%s %llu\n", metric, totalLabel, (unsigned long long)histogram->count);
+
+        memset(histogram->counts, 0, sizeof(histogram->counts));
+        histogram->windowCount = 0;
+        histogram->windowMax = 0;
+    }
+
+    pthread_mutex_unlock(&stats->lock);
+
+    if (fclose(fp) != 0)
+    {
+        remove(stats->tmpPath);
+        return false;
+    }
+
+    if (rename(stats->tmpPath, stats->path) == -1)
+    {
+        remove(stats->tmpPath);
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+uint64_t
+statsClock(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
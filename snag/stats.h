@@ -0,0 +1,92 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef STATS_H
+#define STATS_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Per-frame statistics for --stats. Each value goes into a log-linear
+// (HDR style) histogram with 16 buckets per power of two, so any value
+// is recorded to within about 6% in a fixed 4KB of counters.
+//
+// writeStats() replaces a file in the Prometheus text format, readable by
+// node_exporter's textfile collector or a plain cat. Quantiles cover the
+// frames since the previous write; the _sum and _count totals cover the
+// whole run. Stages on different threads may record into the same Stats.
+
+typedef enum
+{
+    STAT_CAPTURE,               // nanoseconds to grab a frame
+    STAT_SCALE,                 // nanoseconds to scale it to the panel
+    STAT_DIFF,                  // nanoseconds to find the changed rows
+    STAT_CONVERT,               // nanoseconds to dither them
+    STAT_WRITE,                 // nanoseconds to flush them to the panel
+    STAT_FRAME,                 // nanoseconds from capture to flush
+    STAT_CHANGED_ROWS,
+    STAT_CHANGED_PIXELS,
+    STATS
+} Stat;
+
+typedef struct Stats Stats;
+
+//-------------------------------------------------------------------------
+
+// Fails if path cannot be written.
+
+Stats *
+createStats(
+    const char *path);
+
+void
+destroyStats(
+    Stats *stats);
+
+void
+recordStat(
+    Stats *stats,
+    Stat stat,
+    uint64_t value);
+
+bool
+writeStats(
+    Stats *stats);
+
+// CLOCK_MONOTONIC in nanoseconds.
+
+uint64_t
+statsClock(void);
+
+//-------------------------------------------------------------------------
+
+#endif
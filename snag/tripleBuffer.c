@@ -0,0 +1,144 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+
+#include <limits.h>
+#include <unistd.h>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "tripleBuffer.h"
+
+//-------------------------------------------------------------------------
+
+#define SLOT_MASK 0x3
+#define FRESH 0x4               // the middle slot has not been taken
+#define CLOSED 0x8              // nothing more will be published
+
+//-------------------------------------------------------------------------
+
+static void
+futexWait(
+    _Atomic uint32_t *word,
+    uint32_t expected)
+{
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+//-------------------------------------------------------------------------
+
+static void
+futexWake(
+    _Atomic uint32_t *word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+//-------------------------------------------------------------------------
+
+void
+initTripleBuffer(
+    TripleBuffer *buffer,
+    void *slot0,
+    void *slot1,
+    void *slot2)
+{
+    buffer->slots[0] = slot0;
+    buffer->slots[1] = slot1;
+    buffer->slots[2] = slot2;
+    buffer->back = 0;
+    buffer->front = 2;
+    atomic_init(&buffer->state, 1);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+publishTripleBuffer(
+    TripleBuffer *buffer)
+{
+    uint32_t old = atomic_exchange_explicit(&buffer->state,
+                                            buffer->back | FRESH,
+                                            memory_order_acq_rel);
+
+    buffer->back = old & SLOT_MASK;
+    futexWake(&buffer->state);
+
+    return (old & FRESH) != 0;
+}
+
+//-------------------------------------------------------------------------
+
+void *
+waitTripleBuffer(
+    TripleBuffer *buffer)
+{
+    uint32_t state = atomic_load_explicit(&buffer->state, memory_order_acquire);
+
+    for (;;)
+    {
+        if ((state & FRESH) == 0)
+        {
+            if (state & CLOSED)
+            {
+                return NULL;
+            }
+
+            futexWait(&buffer->state, state);
+            state = atomic_load_explicit(&buffer->state, memory_order_acquire);
+            continue;
+        }
+
+        // a compare and swap rather than an exchange, so a publish or a
+        // close in between is not overwritten
+        if (atomic_compare_exchange_weak_explicit(&buffer->state,
+                                                  &state,
+                                                  buffer->front | (state & CLOSED),
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire))
+        {
+            break;
+        }
+    }
+
+    buffer->front = state & SLOT_MASK;
+
+    return buffer->slots[buffer->front];
+}
+
+//-------------------------------------------------------------------------
+
+void
+closeTripleBuffer(
+    TripleBuffer *buffer)
+{
+    atomic_fetch_or_explicit(&buffer->state, CLOSED, memory_order_acq_rel);
+    futexWake(&buffer->state);
+}
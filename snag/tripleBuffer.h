@@ -0,0 +1,101 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+//-------------------------------------------------------------------------
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// Hands frames from one producer thread to one consumer thread without
+// locks. Of three slots the producer owns one (the back) and the
+// consumer one (the front); the third (the middle) is swapped with either
+// in one atomic exchange. publishTripleBuffer() swaps the back with the
+// middle, and the consumer takes the middle when it holds a frame newer
+// than its front. A frame not taken before the next is published is
+// dropped, so the consumer always gets the newest frame and is at most
+// one frame behind.
+//
+// Consumers sleep on a futex on the shared word while nothing is new.
+
+typedef struct
+{
+    void *slots[3];
+    _Atomic uint32_t state;     // middle slot, FRESH and CLOSED bits
+    uint32_t back;              // the producer's
+    uint32_t front;             // the consumer's
+} TripleBuffer;
+
+//-------------------------------------------------------------------------
+
+void
+initTripleBuffer(
+    TripleBuffer *buffer,
+    void *slot0,
+    void *slot1,
+    void *slot2);
+
+// The producer's slot, to be filled and published.
+
+static inline void *
+tripleBufferBack(
+    TripleBuffer *buffer)
+{
+    return buffer->slots[buffer->back];
+}
+
+// Makes the back slot the newest frame. Returns true if the frame it
+// replaces was never taken, i.e. was dropped.
+
+bool
+publishTripleBuffer(
+    TripleBuffer *buffer);
+
+// Blocks until a frame newer than the front slot is published and
+// returns it as the new front, or returns NULL once the buffer is closed
+// and nothing new is left.
+
+void *
+waitTripleBuffer(
+    TripleBuffer *buffer);
+
+// Called by the producer after its last publish. The consumer still gets
+// the last frame, then NULL.
+
+void
+closeTripleBuffer(
+    TripleBuffer *buffer);
+
+//-------------------------------------------------------------------------
+
+#endif
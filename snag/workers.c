@@ -0,0 +1,223 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "workers.h"
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    Workers *workers;
+    uint32_t y0;
+    uint32_t y1;
+    pthread_t thread;
+} Strip;
+
+struct Workers
+{
+    uint32_t threads;
+    Strip *strips;
+    pthread_mutex_t starting;   // held until every thread is created
+    pthread_barrier_t start;
+    pthread_barrier_t done;
+    WorkerFunction function;
+    void *context;
+    bool quit;
+};
+
+//-------------------------------------------------------------------------
+
+static void *
+workerThread(
+    void *arg)
+{
+    Strip *strip = arg;
+    Workers *workers = strip->workers;
+
+    // the barriers are only set up once all the threads are running
+    pthread_mutex_lock(&workers->starting);
+    pthread_mutex_unlock(&workers->starting);
+
+    if (workers->quit)
+    {
+        return NULL;
+    }
+
+    for (;;)
+    {
+        pthread_barrier_wait(&workers->start);
+
+        if (workers->quit)
+        {
+            break;
+        }
+
+        workers->function(workers->context, strip->y0, strip->y1);
+
+        pthread_barrier_wait(&workers->done);
+    }
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+Workers *
+createWorkers(
+    uint32_t threads,
+    uint32_t rows,
+    uint32_t alignment)
+{
+    uint32_t units = (rows + alignment - 1) / alignment;
+
+    if (threads > units)
+    {
+        threads = units;
+    }
+
+    if (threads < 2)
+    {
+        return NULL;
+    }
+
+    Workers *workers = calloc(1, sizeof(Workers));
+    Strip *strips = calloc(threads, sizeof(Strip));
+
+    if ((workers == NULL) || (strips == NULL))
+    {
+        free(strips);
+        free(workers);
+        return NULL;
+    }
+
+    workers->threads = threads;
+    workers->strips = strips;
+
+    // Hand out whole pattern periods, the first strips taking any remainder
+    uint32_t y = 0;
+
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        uint32_t count = units / threads + ((i < units % threads) ? 1 : 0);
+
+        strips[i].workers = workers;
+        strips[i].y0 = y;
+        y += count * alignment;
+        strips[i].y1 = (y < rows) ? y : rows;
+    }
+
+    pthread_mutex_init(&workers->starting, NULL);
+    pthread_mutex_lock(&workers->starting);
+
+    uint32_t started = 1;
+
+    while ((started < threads) &&
+           (pthread_create(&strips[started].thread,
+                           NULL,
+                           workerThread,
+                           &strips[started]) == 0))
+    {
+        ++started;
+    }
+
+    if (started < threads)
+    {
+        // the threads started leave before reaching a barrier, and the
+        // caller falls back to a single thread
+        workers->quit = true;
+        pthread_mutex_unlock(&workers->starting);
+
+        for (uint32_t i = 1; i < started; i++)
+        {
+            pthread_join(strips[i].thread, NULL);
+        }
+
+        pthread_mutex_destroy(&workers->starting);
+        free(strips);
+        free(workers);
+        return NULL;
+    }
+
+    pthread_barrier_init(&workers->start, NULL, threads);
+    pthread_barrier_init(&workers->done, NULL, threads);
+    pthread_mutex_unlock(&workers->starting);
+
+    return workers;
+}
+
+//-------------------------------------------------------------------------
+
+void
+runWorkers(
+    Workers *workers,
+    WorkerFunction function,
+    void *context)
+{
+    workers->function = function;
+    workers->context = context;
+
+    pthread_barrier_wait(&workers->start);
+
+    function(context, workers->strips[0].y0, workers->strips[0].y1);
+
+    pthread_barrier_wait(&workers->done);
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyWorkers(
+    Workers *workers)
+{
+    if (workers == NULL)
+    {
+        return;
+    }
+
+    if (workers->threads > 1)
+    {
+        workers->quit = true;
+        pthread_barrier_wait(&workers->start);
+
+        for (uint32_t i = 1; i < workers->threads; i++)
+        {
+            pthread_join(workers->strips[i].thread, NULL);
+        }
+    }
+
+    pthread_barrier_destroy(&workers->start);
+    pthread_barrier_destroy(&workers->done);
+    pthread_mutex_destroy(&workers->starting);
+    free(workers->strips);
+    free(workers);
+}
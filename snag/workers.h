@@ -0,0 +1,71 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Andrew Duncan
+// Copyright (c) 2023 TheMediocritist
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef WORKERS_H
+#define WORKERS_H
+
+//-------------------------------------------------------------------------
+
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+// A pool of threads that persists across frames. Each run splits the rows
+// of a frame into one strip per thread, with strip boundaries on multiples
+// of alignment rows (the dither pattern period), and returns once every
+// strip is done. The calling thread converts the first strip itself.
+
+typedef void
+(*WorkerFunction)(
+    void *context,
+    uint32_t y0,
+    uint32_t y1);
+
+typedef struct Workers Workers;
+
+//-------------------------------------------------------------------------
+
+Workers *
+createWorkers(
+    uint32_t threads,
+    uint32_t rows,
+    uint32_t alignment);
+
+void
+runWorkers(
+    Workers *workers,
+    WorkerFunction function,
+    void *context);
+
+void
+destroyWorkers(
+    Workers *workers);
+
+//-------------------------------------------------------------------------
+
+#endif